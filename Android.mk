@@ -5,7 +5,12 @@ include $(CLEAR_VARS)
 LOCAL_MODULE := jnicpp11_static
 LOCAL_MODULE_FILENAME := libjnicpp11
 
-LOCAL_SRC_FILES := JniCpp11.cpp
+LOCAL_SRC_FILES := JniCpp11.cpp \
+  JniCpp11Convert.cpp \
+  JniCpp11Iteration.cpp \
+  JniCpp11Async.cpp \
+  JniCpp11Trace.cpp \
+  JniCpp11Batch.cpp
 LOCAL_CPP_FEATURES += exceptions
 LOCAL_EXPORT_C_INCLUDES := $(LOCAL_PATH)
 LOCAL_C_INCLUDES := $(LOCAL_PATH) \
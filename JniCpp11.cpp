@@ -1,5 +1,8 @@
 #include "JniCpp11.h"
 
+#include <algorithm>
+#include <atomic>
+
 #include <pthread.h>
 
 #ifdef __ANDROID__
@@ -73,13 +76,15 @@ JNIEnv *Jni::getEnv() {
         pthread_setspecific(g_key, env);
         return env;
 
-      case JNI_EDETACHED:
+      case JNI_EDETACHED: {
+        JNICPP11_TRACE_SPAN("attachThread");
         if (jvm->AttachCurrentThread(&env, nullptr) < 0) {
           return nullptr;
         } else {
           pthread_setspecific(g_key, env);
           return env;
         }
+      }
 
       default:
         return nullptr;
@@ -140,23 +145,39 @@ static typename std::enable_if<std::is_base_of<_jobject, T>::value, std::shared_
   return nullptr;
 }
 
+// Remembers the env, i.e. the thread, a local reference was created on, for env_util::checkReference.
+struct LocalRefDeleter {
+  JNIEnv *owner;
+  void operator()(jobject jref) const { localRefDeleter(jref); }
+};
+
 template <typename T>
 static typename std::enable_if<std::is_base_of<_jobject, T>::value, std::shared_ptr<T>>::type toLocalRefSharedPtr(T *localRef) {
+#if JNICPP11_VALIDATION >= JNICPP11_VALIDATION_STRICT
+  if (localRef) {
+    return std::shared_ptr<T>(localRef, LocalRefDeleter{Jni::getEnv()});
+  }
+#endif
   return std::shared_ptr<T>(localRef, localRefDeleter);
 }
 
 #pragma mark - JavaClass
 
-JNIEnv *JavaClass::checkAndGetEnv() const throw(JniException) {
+JNIEnv *JavaClass::checkAndGetEnv() const JNICPP11_THROWS(JniException) {
   JNIEnv *env = Jni::getEnv();
+  // always resolved: a class created from a class path is looked up lazily here
+  jclass jclazz = getJClass();
+#if JNICPP11_VALIDATION >= JNICPP11_VALIDATION_DEFAULT
   if (env == nullptr) {
     throw JniException("Failed to get JNIEnv. ");
   }
 
-  jclass jclazz = getJClass();
   if (jclazz == nullptr) {
     throw JniException("Failed to get jclass.");
   }
+#else
+  (void)jclazz;
+#endif
 
   return env;
 }
@@ -168,78 +189,203 @@ JavaClass JavaClass::getClass(const std::string &classPath) {
   }
   try {
     jclass clazz = env_util::findClass(env, classPath);
-    return JavaClass(clazz, classPath);
+    JavaClass ret(clazz, classPath);
+    env->DeleteLocalRef(clazz);
+    return ret;
   } catch (const JniException &e) {
     e.log();
   }
   return nullptr;
 }
 
-JavaClass::JavaClass(jclass clazz) : _jclazz(toGlobalRefSharedPtr(clazz)) {}
+/**
+ *  Shared by all copies of a JavaClass. classPath is fixed at construction; jclazz and resolvedClassPath start out
+ *  empty and are published at most once with a compare-and-swap, the losing thread dropping its duplicate.
+ */
+struct JavaClass::State {
+  explicit State(const std::string &classPath) : classPath(classPath) {}
+  ~State() {
+    globalRefDeleter(jclazz.load(std::memory_order_acquire));
+    delete resolvedClassPath.load(std::memory_order_acquire);
+  }
+
+  std::atomic<int> refs{1};
+  const std::string classPath;
+  std::atomic<jclass> jclazz{nullptr};
+  std::atomic<const std::string *> resolvedClassPath{nullptr};
+};
+
+template <typename T> static T *publishOnce(std::atomic<T *> &slot, T *value) {
+  T *expected = nullptr;
+  if (slot.compare_exchange_strong(expected, value, std::memory_order_acq_rel, std::memory_order_acquire)) {
+    return value;
+  }
+  return expected;
+}
+
+static jclass newGlobalClassRef(jclass clazz) {
+  JNIEnv *env = Jni::getEnv();
+  if (clazz == nullptr || env == nullptr) {
+    return nullptr;
+  }
+  return (jclass)env->NewGlobalRef(clazz);
+}
+
+JavaClass::State *JavaClass::_newState(jclass clazz, const std::string &classPath) {
+  if (clazz == nullptr && classPath.empty()) {
+    return nullptr;
+  }
+  State *state = new State(classPath);
+  state->jclazz.store(newGlobalClassRef(clazz), std::memory_order_relaxed);
+  return state;
+}
 
-JavaClass::JavaClass(const std::string &classPath) : _classPath(classPath) {}
+JavaClass::JavaClass(jclass clazz) : _state(_newState(clazz, "")) {}
 
-JavaClass::JavaClass(jclass clazz, const std::string &classPath) : _jclazz(toGlobalRefSharedPtr(clazz)), _classPath(classPath) {}
+JavaClass::JavaClass(const std::string &classPath) : _state(_newState(nullptr, classPath)) {}
+
+JavaClass::JavaClass(jclass clazz, const std::string &classPath) : _state(_newState(clazz, classPath)) {}
+
+JavaClass::JavaClass(const JavaClass &other) : _state(other._retainState()) {}
+
+JavaClass::JavaClass(JavaClass &&other) noexcept : _state(other._state.exchange(nullptr, std::memory_order_acq_rel)) {}
+
+JavaClass &JavaClass::operator=(const JavaClass &other) {
+  _releaseState(_state.exchange(other._retainState(), std::memory_order_acq_rel));
+  return *this;
+}
+
+JavaClass &JavaClass::operator=(JavaClass &&other) noexcept {
+  if (this != &other) {
+    _releaseState(_state.exchange(other._state.exchange(nullptr, std::memory_order_acq_rel), std::memory_order_acq_rel));
+  }
+  return *this;
+}
+
+JavaClass::~JavaClass() { _releaseState(_state.load(std::memory_order_acquire)); }
+
+JavaClass::State *JavaClass::_retainState() const {
+  State *state = _state.load(std::memory_order_acquire);
+  if (state) {
+    state->refs.fetch_add(1, std::memory_order_relaxed);
+  }
+  return state;
+}
+
+void JavaClass::_releaseState(State *state) {
+  if (state && state->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    delete state;
+  }
+}
+
+bool JavaClass::_hasState() const { return _state.load(std::memory_order_acquire) != nullptr; }
+
+jclass JavaClass::_peekJClass() const {
+  State *state = _state.load(std::memory_order_acquire);
+  return state ? state->jclazz.load(std::memory_order_acquire) : nullptr;
+}
+
+jclass JavaClass::_publishJClass(jclass globalRef) const {
+  State *existing = _state.load(std::memory_order_acquire);
+  if (existing) {
+    return publishOnce(existing->jclazz, globalRef);
+  }
+  State *state = new State("");
+  state->jclazz.store(globalRef, std::memory_order_relaxed);
+  State *published = publishOnce(_state, state);
+  if (published != state) {
+    // globalRef stays with the caller, which drops it when it lost
+    state->jclazz.store(nullptr, std::memory_order_relaxed);
+    delete state;
+  }
+  return published->jclazz.load(std::memory_order_acquire);
+}
 
 jclass JavaClass::getJClass() const {
-  if (_jclazz == nullptr) {
-    if (!_classPath.empty()) {
-      JNIEnv *env = Jni::getEnv();
-      if (env == nullptr) {
-        return nullptr;
-      }
-      try {
-        jclass clazz = env_util::findClass(env, _classPath);
-        const_cast<JavaClass *>(this)->_jclazz = toGlobalRefSharedPtr(clazz);
-        env->DeleteLocalRef(clazz);
-      } catch (const JniException &e) {
-        e.log();
+  State *state = _state.load(std::memory_order_acquire);
+  if (state == nullptr) {
+    return nullptr;
+  }
+  jclass clazz = state->jclazz.load(std::memory_order_acquire);
+  if (clazz == nullptr && !state->classPath.empty()) {
+    JNIEnv *env = Jni::getEnv();
+    if (env == nullptr) {
+      return nullptr;
+    }
+    try {
+      jclass localClazz = env_util::findClass(env, state->classPath);
+      jclass globalClazz = newGlobalClassRef(localClazz);
+      env->DeleteLocalRef(localClazz);
+      clazz = publishOnce(state->jclazz, globalClazz);
+      if (clazz != globalClazz) {
+        globalRefDeleter(globalClazz);
       }
+    } catch (const JniException &e) {
+      e.log();
     }
   }
-  return _jclazz.get();
+  return clazz;
 }
 
-std::string JavaClass::getTypeSignature() const { return "L" + getClassPath() + ";"; }
+std::string JavaClass::getTypeSignature() const {
+  std::string classPath = getClassPath();
+  // array classes are named by their type signature
+  return classPath[0] == '[' ? classPath : "L" + classPath + ";";
+}
 
 std::string JavaClass::getClassPath() const {
   constexpr const char *defaultRet = "java/lang/Object";
 
-  if (_classPath.empty()) {
-    JNIEnv *env = Jni::getEnv();
-    if (env == nullptr) {
-      return defaultRet;
-    }
-
-    jclass clazz = getJClass();
-    if (clazz == nullptr) {
-      return defaultRet;
-    }
+  State *state = _state.load(std::memory_order_acquire);
+  if (state == nullptr) {
+    return defaultRet;
+  }
+  if (!state->classPath.empty()) {
+    return state->classPath;
+  }
+  const std::string *resolved = state->resolvedClassPath.load(std::memory_order_acquire);
+  if (resolved) {
+    return *resolved;
+  }
 
-    jclass clazzRet = (jclass)env->NewLocalRef(clazz);
-    if (clazzRet == nullptr) {
-      LOGD("NewLocalRef failed");
-      return defaultRet;
+  JNIEnv *env = Jni::getEnv();
+  jclass clazz = state->jclazz.load(std::memory_order_acquire);
+  if (env == nullptr || clazz == nullptr) {
+    return defaultRet;
+  }
+  try {
+    jclass classClass = env->GetObjectClass(clazz);
+    jmethodID getNameId = env->GetMethodID(classClass, "getName", "()Ljava/lang/String;");
+    env->DeleteLocalRef(classClass);
+    JniException::checkException(env);
+    jstring jname = (jstring)env->CallObjectMethod(clazz, getNameId);
+    JniException::checkException(env);
+    // Class.getName separates packages with dots
+    std::string *name = new std::string(fromJString(jname, defaultRet, true));
+    std::replace(name->begin(), name->end(), '.', '/');
+    resolved = publishOnce(state->resolvedClassPath, (const std::string *)name);
+    if (resolved != name) {
+      delete name;
     }
-
-    JavaObject classObject(clazz, "java/lang/Class");
-    const_cast<JavaClass *>(this)->_classPath = classObject.call<std::string>("getName", "");
-    LOGD("java/lang/Class getName result: %s", _classPath.c_str());
+    LOGD("java/lang/Class getName result: %s", resolved->c_str());
+    return *resolved;
+  } catch (const JniException &e) {
+    e.log();
   }
-  return _classPath;
+  return defaultRet;
 }
 
 JavaObject JavaClass::_newObject(JNIEnv *env, jmethodID methodId, ...) const {
   va_list args;
   va_start(args, methodId);
-  jobject jret = env->NewObjectV(_jclazz.get(), methodId, args);
+  jobject jret = env->NewObjectV(getJClass(), methodId, args);
   va_end(args);
   return JavaObject(jret, *this);
 }
 
-JavaClass::operator bool() const { return _jclazz != nullptr; }
+JavaClass::operator bool() const { return _peekJClass() != nullptr; }
 
-bool JavaClass::operator==(const std::nullptr_t &null) const { return _jclazz == null; }
+bool JavaClass::operator==(const std::nullptr_t &null) const { return _peekJClass() == null; }
 
 #pragma mark - JavaObject
 JavaObject::JavaObject(jobject obj) : _jobject(toLocalRefSharedPtr(obj)), _javaClass(nullptr) {}
@@ -252,8 +398,22 @@ JavaObject::JavaObject(jobject obj, const std::string &classPath) : _jobject(toL
 
 JavaObject JavaObject::null(const std::string &classPath) { return JavaObject(nullptr, classPath); }
 
-JNIEnv *JavaObject::checkAndGetEnv() const throw(JniException) {
+JavaObject JavaObject::borrow(jobject obj) {
+  JavaObject ret(nullptr);
+  // aliasing constructor: points to obj without owning anything
+  ret._jobject = shared_jobject(shared_jobject(), obj);
+  return ret;
+}
+
+JavaObject JavaObject::borrow(jobject obj, const JavaClass &clazz) {
+  JavaObject ret(nullptr, clazz);
+  ret._jobject = shared_jobject(shared_jobject(), obj);
+  return ret;
+}
+
+JNIEnv *JavaObject::checkAndGetEnv() const JNICPP11_THROWS(JniException) {
   JNIEnv *env = Jni::getEnv();
+#if JNICPP11_VALIDATION >= JNICPP11_VALIDATION_DEFAULT
   if (env == nullptr) {
     throw JniException("Failed to get JNIEnv.");
   }
@@ -267,30 +427,76 @@ JNIEnv *JavaObject::checkAndGetEnv() const throw(JniException) {
   if (jobj == nullptr) {
     throw JniException("Failed to get jobject. ");
   }
+#endif
+#if JNICPP11_VALIDATION >= JNICPP11_VALIDATION_STRICT
+  env_util::checkReference(env, *this);
+#endif
   return env;
 }
 
+// FindClass only sees system classes on threads attached from native code, so a class path that did not resolve is
+// loaded through the class loader of an instance instead: the instance's runtime class itself if it has that name,
+// otherwise Class.forName with the runtime class's loader, which also finds superclasses and interfaces.
+static jclass loadClassOf(JNIEnv *env, jobject obj, const std::string &classPath) JNICPP11_THROWS(JniException) {
+  JavaObject runtimeClass(env->GetObjectClass(obj));
+  if (!runtimeClass) {
+    throw JniException("GetObjectClass failed.");
+  }
+  JniException::checkException(env);
+  if (classPath.empty()) {
+    return (jclass)env->NewLocalRef(runtimeClass.getJObject());
+  }
+  std::string name = classPath;
+  std::replace(name.begin(), name.end(), '/', '.');
+  JavaObject classClass(env->GetObjectClass(runtimeClass.getJObject()));
+  jmethodID getNameId = env_util::getMethodId(env, (jclass)classClass.getJObject(), "getName", "()Ljava/lang/String;", false);
+  JavaObject runtimeName(env->CallObjectMethod(runtimeClass.getJObject(), getNameId));
+  JniException::checkException(env);
+  if (fromJString(runtimeName) == name) {
+    return (jclass)env->NewLocalRef(runtimeClass.getJObject());
+  }
+  jmethodID getClassLoaderId =
+      env_util::getMethodId(env, (jclass)classClass.getJObject(), "getClassLoader", "()Ljava/lang/ClassLoader;", false);
+  jmethodID forNameId = env_util::getMethodId(env,
+                                              (jclass)classClass.getJObject(),
+                                              "forName",
+                                              "(Ljava/lang/String;ZLjava/lang/ClassLoader;)Ljava/lang/Class;",
+                                              true);
+  JavaObject loader(env->CallObjectMethod(runtimeClass.getJObject(), getClassLoaderId));
+  JniException::checkException(env);
+  JavaObject jname = toJString(name);
+  jclass clazz = (jclass)env->CallStaticObjectMethod(
+      (jclass)classClass.getJObject(), forNameId, jname.getJObject(), JNI_FALSE, loader.getJObject());
+  JniException::checkException(env);
+  if (clazz == nullptr) {
+    throw JniException("Class not found: " + classPath);
+  }
+  return clazz;
+}
+
 jclass JavaObject::getJClass() const {
-  if (_javaClass == nullptr) {
-    if (_jobject) {
-      JNIEnv *env = Jni::getEnv();
-      if (env == nullptr) {
-        return nullptr;
-      }
-      try {
-        jclass clazz = env->GetObjectClass(_jobject.get());
-        if (clazz == nullptr) {
-          throw JniException("GetObjectClass failed.");
-        }
-        JniException::checkException(env);
-        const_cast<JavaObject *>(this)->_javaClass = JavaClass(clazz);
-        env->DeleteLocalRef(clazz);
-      } catch (const JniException &e) {
-        e.log();
+  jclass clazz = _javaClass.getJClass();
+  // The runtime class is published into _javaClass when no class was given at construction, and is used to load
+  // the given class when FindClass could not.
+  if (clazz == nullptr && _jobject) {
+    JNIEnv *env = Jni::getEnv();
+    if (env == nullptr) {
+      return nullptr;
+    }
+    try {
+      std::string classPath = _javaClass._hasState() ? _javaClass.getClassPath() : "";
+      jclass localClazz = loadClassOf(env, _jobject.get(), classPath);
+      jclass globalClazz = newGlobalClassRef(localClazz);
+      env->DeleteLocalRef(localClazz);
+      clazz = _javaClass._publishJClass(globalClazz);
+      if (clazz != globalClazz) {
+        globalRefDeleter(globalClazz);
       }
+    } catch (const JniException &e) {
+      e.log();
     }
   }
-  return _javaClass.getJClass();
+  return clazz;
 }
 
 JavaObject JavaObject::asType(const JavaClass &clazz) const {
@@ -299,6 +505,12 @@ JavaObject JavaObject::asType(const JavaClass &clazz) const {
   return ret;
 }
 
+JavaObject JavaObject::toGlobalRef() const {
+  JavaObject ret(nullptr, _javaClass);
+  ret._jobject = toGlobalRefSharedPtr(_jobject.get());
+  return ret;
+}
+
 jobject JavaObject::getJObject() const { return _jobject.get(); }
 
 std::string JavaObject::getClassPath() const {
@@ -316,24 +528,267 @@ JavaObject::operator bool() const { return _jobject != nullptr; }
 bool JavaObject::operator==(const std::nullptr_t &null) const { return _jobject == null; }
 
 #pragma mark - JavaArray
-JavaArray<JavaObject>::JavaArray(jobject obj) : JavaObject(obj) {}
+JavaArray<JavaObject>::JavaArray(jobject obj) : JavaObject(obj), _elementClass(nullptr) {}
+
 JavaArray<JavaObject>::JavaArray(jobject obj, const std::string &elementClassPath)
-    : JavaObject(obj), _elementClassPath(elementClassPath) {}
+    : JavaObject(obj), _elementClass(elementClassPath) {}
+
+JavaArray<JavaObject>::JavaArray(jobject obj, const JavaClass &elementClass) : JavaObject(obj), _elementClass(elementClass) {}
 
 JavaArray<JavaObject> JavaArray<JavaObject>::null(const std::string &elementClassPath) {
   return JavaArray<JavaObject>(nullptr, elementClassPath);
 }
 
-std::string JavaArray<JavaObject>::getElementClassPath() const {
-  // TODO: lazy
-  return _elementClassPath;
+JavaArray<JavaObject> JavaArray<JavaObject>::from(const JavaObject *elements, jsize size, const JavaClass &elementClass) {
+  JNIEnv *env = Jni::getEnv();
+  if (env == nullptr) {
+    return nullptr;
+  }
+  jobjectArray array = nullptr;
+  try {
+    jclass clazz = elementClass.getJClass();
+    if (clazz == nullptr) {
+      throw JniException("Failed to get element jclass.");
+    }
+    array = env->NewObjectArray(size, clazz, nullptr);
+    JniException::checkException(env);
+    if (array == nullptr) {
+      throw JniException("Failed to create array.");
+    }
+    for (jsize i = 0; i < size; ++i) {
+      env->SetObjectArrayElement(array, i, elements[i].getJObject());
+      JniException::checkException(env);
+    }
+    return JavaArray<JavaObject>(array, elementClass);
+  } catch (const JniException &e) {
+    e.log();
+    if (array) {
+      env->DeleteLocalRef(array);
+    }
+  }
+  return nullptr;
+}
+
+JavaArray<JavaObject> JavaArray<JavaObject>::from(const std::vector<JavaObject> &elements, const JavaClass &elementClass) {
+  return from(elements.data(), (jsize)elements.size(), elementClass);
+}
+
+JNIEnv *JavaArray<JavaObject>::checkAndGetEnv() const JNICPP11_THROWS(JniException) {
+  JNIEnv *env = Jni::getEnv();
+#if JNICPP11_VALIDATION >= JNICPP11_VALIDATION_DEFAULT
+  if (env == nullptr) {
+    throw JniException("Failed to get JNIEnv.");
+  }
+  if (getJObject() == nullptr) {
+    throw JniException("Failed to get jobject. ");
+  }
+#endif
+#if JNICPP11_VALIDATION >= JNICPP11_VALIDATION_STRICT
+  env_util::checkReference(env, *this);
+#endif
+  // out of range indices are reported by JNI as ArrayIndexOutOfBoundsException
+  return env;
+}
+
+jsize JavaArray<JavaObject>::length() const {
+  JNIEnv *env = Jni::getEnv();
+  if (env == nullptr || getJObject() == nullptr) {
+    return 0;
+  }
+  return env->GetArrayLength((jarray)getJObject());
+}
+
+JavaObject JavaArray<JavaObject>::get(jsize index) const {
+  JNIEnv *env = nullptr;
+  try {
+    env = checkAndGetEnv();
+    jobject element = env->GetObjectArrayElement((jobjectArray)getJObject(), index);
+    JniException::checkException(env);
+    return JavaObject(element, getElementClass());
+  } catch (const JniException &e) {
+    e.log();
+  }
+  return nullptr;
+}
+
+bool JavaArray<JavaObject>::set(jsize index, const JavaObject &value) const {
+  JNIEnv *env = nullptr;
+  try {
+    env = checkAndGetEnv();
+    env->SetObjectArrayElement((jobjectArray)getJObject(), index, value.getJObject());
+    JniException::checkException(env);
+    return true;
+  } catch (const JniException &e) {
+    e.log();
+  }
+  return false;
+}
+
+JavaClass JavaArray<JavaObject>::getElementClass() const {
+  if (_elementClass._hasState() || getJObject() == nullptr) {
+    return _elementClass;
+  }
+  JNIEnv *env = Jni::getEnv();
+  if (env == nullptr) {
+    return _elementClass;
+  }
+  jclass arrayClass = nullptr;
+  jclass classClass = nullptr;
+  try {
+    // taken from the array itself, so no FindClass (and no class loader) is involved
+    arrayClass = env->GetObjectClass(getJObject());
+    classClass = env->GetObjectClass(arrayClass);
+    jmethodID getComponentTypeId = env_util::getMethodId(env, classClass, "getComponentType", "()Ljava/lang/Class;", false);
+    jclass componentClass = (jclass)env->CallObjectMethod(arrayClass, getComponentTypeId);
+    JniException::checkException(env);
+    jclass globalClazz = newGlobalClassRef(componentClass);
+    env->DeleteLocalRef(componentClass);
+    if (_elementClass._publishJClass(globalClazz) != globalClazz) {
+      globalRefDeleter(globalClazz);
+    }
+  } catch (const JniException &e) {
+    e.log();
+  }
+  env->DeleteLocalRef(classClass);
+  env->DeleteLocalRef(arrayClass);
+  return _elementClass;
 }
 
-std::string JavaArray<JavaObject>::getTypeSignature() const { return "[L" + getElementClassPath() + ";"; }
+std::string JavaArray<JavaObject>::getElementClassPath() const { return getElementClass().getClassPath(); }
+
+std::string JavaArray<JavaObject>::getTypeSignature() const { return "[" + getElementClass().getTypeSignature(); }
+
+#define ARRAY_SPEC(TYPE, TYPE_NAME)                                                                                     \
+  template <> jarray JavaArray<TYPE>::_newArray(JNIEnv *env, jsize size) { return env->New##TYPE_NAME##Array(size); }   \
+  template <> void JavaArray<TYPE>::_setRegion(JNIEnv *env, jarray array, jsize offset, jsize size, const TYPE *data) { \
+    env->Set##TYPE_NAME##ArrayRegion((TYPE##Array)array, offset, size, data);                                           \
+  }                                                                                                                     \
+  template <> void JavaArray<TYPE>::_getRegion(JNIEnv *env, jarray array, jsize offset, jsize size, TYPE *out) {        \
+    env->Get##TYPE_NAME##ArrayRegion((TYPE##Array)array, offset, size, out);                                            \
+  }
+
+ARRAY_SPEC(jboolean, Boolean);
+ARRAY_SPEC(jbyte, Byte);
+ARRAY_SPEC(jchar, Char);
+ARRAY_SPEC(jshort, Short);
+ARRAY_SPEC(jint, Int);
+ARRAY_SPEC(jlong, Long);
+ARRAY_SPEC(jfloat, Float);
+ARRAY_SPEC(jdouble, Double);
+
+// std::vector<bool> does not expose its storage, so it is converted element by element while the array is pinned
+template <> JavaArray<jboolean> JavaArray<jboolean>::from(const std::vector<bool> &data) {
+  JNIEnv *env = Jni::getEnv();
+  if (env == nullptr) {
+    return nullptr;
+  }
+  jsize size = (jsize)data.size();
+  jarray array = nullptr;
+  try {
+    array = _newArray(env, size);
+    if (array == nullptr) {
+      throw JniException("Failed to create array.");
+    }
+    if (size > 0) {
+      jboolean *elements = static_cast<jboolean *>(env->GetPrimitiveArrayCritical(array, nullptr));
+      if (elements == nullptr) {
+        throw JniException("GetPrimitiveArrayCritical failed.");
+      }
+      for (jsize i = 0; i < size; ++i) {
+        elements[i] = data[i] ? JNI_TRUE : JNI_FALSE;
+      }
+      env->ReleasePrimitiveArrayCritical(array, elements, 0);
+    }
+    JniException::checkException(env);
+    return JavaArray<jboolean>(array);
+  } catch (const JniException &e) {
+    e.log();
+    if (array) {
+      env->DeleteLocalRef(array);
+    }
+  }
+  return nullptr;
+}
+
+template <> JavaArray<jboolean> JavaArray<jboolean>::fromBits(const uint8_t *bits, jsize size) {
+  JNIEnv *env = Jni::getEnv();
+  if (env == nullptr) {
+    return nullptr;
+  }
+  jarray array = nullptr;
+  try {
+    array = _newArray(env, size);
+    if (array == nullptr) {
+      throw JniException("Failed to create array.");
+    }
+    if (size > 0) {
+      jboolean *elements = static_cast<jboolean *>(env->GetPrimitiveArrayCritical(array, nullptr));
+      if (elements == nullptr) {
+        throw JniException("GetPrimitiveArrayCritical failed.");
+      }
+      convert::unpackBits(bits, elements, size);
+      env->ReleasePrimitiveArrayCritical(array, elements, 0);
+    }
+    JniException::checkException(env);
+    return JavaArray<jboolean>(array);
+  } catch (const JniException &e) {
+    e.log();
+    if (array) {
+      env->DeleteLocalRef(array);
+    }
+  }
+  return nullptr;
+}
+
+template <> bool JavaArray<jboolean>::copyTo(std::vector<bool> &out) const {
+  JNIEnv *env = nullptr;
+  try {
+    jsize size = length();
+    env = checkAndGetEnv(0, size);
+    out.resize(size);
+    if (size > 0) {
+      jarray array = (jarray)getJObject();
+      jboolean *elements = static_cast<jboolean *>(env->GetPrimitiveArrayCritical(array, nullptr));
+      if (elements == nullptr) {
+        throw JniException("GetPrimitiveArrayCritical failed.");
+      }
+      for (jsize i = 0; i < size; ++i) {
+        out[i] = elements[i] != JNI_FALSE;
+      }
+      env->ReleasePrimitiveArrayCritical(array, elements, JNI_ABORT);
+    }
+    JniException::checkException(env);
+    return true;
+  } catch (const JniException &e) {
+    e.log();
+  }
+  return false;
+}
+
+template <> bool JavaArray<jboolean>::copyToBits(uint8_t *bits, jsize offset, jsize size) const {
+  JNIEnv *env = nullptr;
+  try {
+    env = checkAndGetEnv(offset, size);
+    if (size > 0) {
+      jarray array = (jarray)getJObject();
+      jboolean *elements = static_cast<jboolean *>(env->GetPrimitiveArrayCritical(array, nullptr));
+      if (elements == nullptr) {
+        throw JniException("GetPrimitiveArrayCritical failed.");
+      }
+      convert::packBits(elements + offset, bits, size);
+      env->ReleasePrimitiveArrayCritical(array, elements, JNI_ABORT);
+    }
+    JniException::checkException(env);
+    return true;
+  } catch (const JniException &e) {
+    e.log();
+  }
+  return false;
+}
 
 #pragma mark - JniException
 
-void JniException::checkException(JNIEnv *env) throw(JniException) {
+void JniException::checkException(JNIEnv *env) JNICPP11_THROWS(JniException) {
   if (env->ExceptionCheck()) {
     env->ExceptionDescribe();
     env->ExceptionClear();
@@ -380,6 +835,7 @@ template <> std::string TypeSignature::get<jdoubleArray>() { return "[D"; }
 #pragma mark - Type Casters
 
 JavaObject toJString(const std::string &str) {
+  JNICPP11_TRACE_SPAN("toJString");
   JNIEnv *env = Jni::getEnv();
   jsize strLen = (jsize)str.size();
   if (strLen == 0) {
@@ -420,7 +876,11 @@ std::string fromJString(const JavaObject &jstr, const std::string &defaultValue)
 }
 
 std::string fromJString(jstring jstr, const std::string &defaultValue, bool deleteLocalRef) {
+  JNICPP11_TRACE_SPAN("fromJString");
   JNIEnv *env = Jni::getEnv();
+  if (jstr == nullptr) {
+    return defaultValue;
+  }
   const char *chars = env->GetStringUTFChars(jstr, NULL);
   if (chars == nullptr) {
     return defaultValue;
@@ -439,14 +899,14 @@ std::string fromJString(jstring jstr, const std::string &defaultValue, bool dele
   template <> TYPE JavaClass::__staticCall(JNIEnv *env, jmethodID methodId, ...) const { \
     va_list args;                                                                        \
     va_start(args, methodId);                                                            \
-    auto ret = env->CallStatic##TYPE_NAME##MethodV(_jclazz.get(), methodId, args);       \
+    auto ret = env->CallStatic##TYPE_NAME##MethodV(getJClass(), methodId, args);       \
     va_end(args);                                                                        \
     return ret;                                                                          \
   }
 
 #define GET_STATIC_FIELD(TYPE, TYPE_NAME)                                         \
   template <> TYPE JavaClass::_staticField(JNIEnv *env, jfieldID fieldId) const { \
-    return env->GetStatic##TYPE_NAME##Field(_jclazz.get(), fieldId);              \
+    return env->GetStatic##TYPE_NAME##Field(getJClass(), fieldId);              \
   }
 
 #define GET_FIELD(TYPE, TYPE_NAME)                                           \
@@ -487,7 +947,7 @@ TEMPLATE_SPEC(jdouble, Double);
 template <> void JavaClass::__staticCall(JNIEnv *env, jmethodID methodId, ...) const {
   va_list args;
   va_start(args, methodId);
-  env->CallStaticVoidMethodV(_jclazz.get(), methodId, args);
+  env->CallStaticVoidMethodV(getJClass(), methodId, args);
   va_end(args);
 }
 
@@ -510,7 +970,7 @@ template <> std::string JavaObject::__call(JNIEnv *env, jmethodID methodId, ...)
 template <> std::string JavaClass::__staticCall(JNIEnv *env, jmethodID methodId, ...) const {
   va_list args;
   va_start(args, methodId);
-  jstring jret = (jstring)env->CallStaticObjectMethodV(_jclazz.get(), methodId, args);
+  jstring jret = (jstring)env->CallStaticObjectMethodV(getJClass(), methodId, args);
   va_end(args);
   return fromJString(jret, "", true);
 }
@@ -521,27 +981,271 @@ template <> std::string JavaObject::_field(JNIEnv *env, jfieldID fieldId) const
 }
 
 template <> std::string JavaClass::_staticField(JNIEnv *env, jfieldID fieldId) const {
-  jstring jret = (jstring)env->GetStaticObjectField(_jclazz.get(), fieldId);
+  jstring jret = (jstring)env->GetStaticObjectField(getJClass(), fieldId);
+  return fromJString(jret, "", true);
+}
+
+#pragma mark - JavaField, JavaStaticField template specializations
+
+// NewStringUTF expects modified UTF-8, which only differs from standard UTF-8 for NUL and supplementary characters.
+static jstring newJString(JNIEnv *env, const std::string &str) {
+  bool isModifiedUtf8 = true;
+  for (unsigned char c : str) {
+    if (c == 0 || c >= 0xF0) {
+      isModifiedUtf8 = false;
+      break;
+    }
+  }
+  if (isModifiedUtf8) {
+    return env->NewStringUTF(str.c_str());
+  }
+  JavaObject jstr = toJString(str);
+  return (jstring)env->NewLocalRef(jstr.getJObject());
+}
+
+#define FIELD_ACCESSOR(TYPE, TYPE_NAME)                                                                   \
+  template <> TYPE JavaField<TYPE>::_get(JNIEnv *env, jobject obj, jfieldID fieldId) {                    \
+    return env->Get##TYPE_NAME##Field(obj, fieldId);                                                      \
+  }                                                                                                       \
+  template <> void JavaField<TYPE>::_set(JNIEnv *env, jobject obj, jfieldID fieldId, const TYPE &value) { \
+    env->Set##TYPE_NAME##Field(obj, fieldId, value);                                                      \
+  }
+
+#define STATIC_FIELD_ACCESSOR(TYPE, TYPE_NAME)                                                                   \
+  template <> TYPE JavaStaticField<TYPE>::_get(JNIEnv *env, jclass clazz, jfieldID fieldId) {                    \
+    return env->GetStatic##TYPE_NAME##Field(clazz, fieldId);                                                     \
+  }                                                                                                              \
+  template <> void JavaStaticField<TYPE>::_set(JNIEnv *env, jclass clazz, jfieldID fieldId, const TYPE &value) { \
+    env->SetStatic##TYPE_NAME##Field(clazz, fieldId, value);                                                     \
+  }
+
+#define OBJECT_FIELD_ACCESSOR(TYPE)                                                                       \
+  template <> TYPE JavaField<TYPE>::_get(JNIEnv *env, jobject obj, jfieldID fieldId) {                    \
+    return TYPE(env->GetObjectField(obj, fieldId));                                                       \
+  }                                                                                                       \
+  template <> void JavaField<TYPE>::_set(JNIEnv *env, jobject obj, jfieldID fieldId, const TYPE &value) { \
+    env->SetObjectField(obj, fieldId, value.getJObject());                                                \
+  }
+
+#define OBJECT_STATIC_FIELD_ACCESSOR(TYPE)                                                                       \
+  template <> TYPE JavaStaticField<TYPE>::_get(JNIEnv *env, jclass clazz, jfieldID fieldId) {                    \
+    return TYPE(env->GetStaticObjectField(clazz, fieldId));                                                      \
+  }                                                                                                              \
+  template <> void JavaStaticField<TYPE>::_set(JNIEnv *env, jclass clazz, jfieldID fieldId, const TYPE &value) { \
+    env->SetStaticObjectField(clazz, fieldId, value.getJObject());                                               \
+  }
+
+#define FIELD_SPEC(TYPE, TYPE_NAME)      \
+  FIELD_ACCESSOR(TYPE, TYPE_NAME)        \
+  STATIC_FIELD_ACCESSOR(TYPE, TYPE_NAME)
+
+#define OBJECT_FIELD_SPEC(TYPE)      \
+  OBJECT_FIELD_ACCESSOR(TYPE)        \
+  OBJECT_STATIC_FIELD_ACCESSOR(TYPE)
+
+OBJECT_FIELD_SPEC(JavaObject);
+OBJECT_FIELD_SPEC(JavaArray<JavaObject>);
+FIELD_SPEC(jobject, Object);
+FIELD_SPEC(bool, Boolean);
+FIELD_SPEC(jboolean, Boolean);
+FIELD_SPEC(jbyte, Byte);
+FIELD_SPEC(jchar, Char);
+FIELD_SPEC(jshort, Short);
+FIELD_SPEC(jint, Int);
+FIELD_SPEC(long, Long);
+FIELD_SPEC(jlong, Long);
+FIELD_SPEC(jfloat, Float);
+FIELD_SPEC(jdouble, Double);
+
+// for type `std::string`, the jstring is created and released directly instead of going through makeArg
+template <> std::string JavaField<std::string>::_get(JNIEnv *env, jobject obj, jfieldID fieldId) {
+  jstring jret = (jstring)env->GetObjectField(obj, fieldId);
+  return fromJString(jret, "", true);
+}
+
+template <> void JavaField<std::string>::_set(JNIEnv *env, jobject obj, jfieldID fieldId, const std::string &value) {
+  jstring jvalue = newJString(env, value);
+  env->SetObjectField(obj, fieldId, jvalue);
+  env->DeleteLocalRef(jvalue);
+}
+
+template <> std::string JavaStaticField<std::string>::_get(JNIEnv *env, jclass clazz, jfieldID fieldId) {
+  jstring jret = (jstring)env->GetStaticObjectField(clazz, fieldId);
   return fromJString(jret, "", true);
 }
 
+template <> void JavaStaticField<std::string>::_set(JNIEnv *env, jclass clazz, jfieldID fieldId, const std::string &value) {
+  jstring jvalue = newJString(env, value);
+  env->SetStaticObjectField(clazz, fieldId, jvalue);
+  env->DeleteLocalRef(jvalue);
+}
+
+#pragma mark - Boxed template specializations
+
+namespace {
+struct BoxClass {
+  jclass clazz = nullptr;
+  jmethodID valueOf = nullptr;
+  jmethodID unbox = nullptr;
+};
+
+template <typename T> struct BoxTraits;
+
+#define BOX_TRAITS(TYPE, TYPE_NAME, CLASS_PATH, SIGNATURE, UNBOX)                                                           \
+  template <> struct BoxTraits<TYPE> {                                                                                      \
+    static constexpr const char *classPath = CLASS_PATH;                                                                    \
+    static constexpr const char *primitiveSignature = SIGNATURE;                                                            \
+    static constexpr const char *unboxMethod = UNBOX;                                                                       \
+    static TYPE unbox(JNIEnv *env, jobject obj, jmethodID methodId) { return env->Call##TYPE_NAME##Method(obj, methodId); } \
+  };
+
+BOX_TRAITS(bool, Boolean, "java/lang/Boolean", "Z", "booleanValue");
+BOX_TRAITS(jboolean, Boolean, "java/lang/Boolean", "Z", "booleanValue");
+BOX_TRAITS(jbyte, Byte, "java/lang/Byte", "B", "byteValue");
+BOX_TRAITS(jchar, Char, "java/lang/Character", "C", "charValue");
+BOX_TRAITS(jshort, Short, "java/lang/Short", "S", "shortValue");
+BOX_TRAITS(jint, Int, "java/lang/Integer", "I", "intValue");
+BOX_TRAITS(jlong, Long, "java/lang/Long", "J", "longValue");
+BOX_TRAITS(jfloat, Float, "java/lang/Float", "F", "floatValue");
+BOX_TRAITS(jdouble, Double, "java/lang/Double", "D", "doubleValue");
+
+BoxClass resolveBoxClass(JNIEnv *env, const char *classPath, const char *primitiveSignature, const char *unboxMethod) {
+  BoxClass box;
+  jclass clazz = nullptr;
+  try {
+    clazz = env_util::findClass(env, classPath);
+    std::string valueOfSignature = std::string("(") + primitiveSignature + ")L" + classPath + ";";
+    box.valueOf = env_util::getMethodId(env, clazz, "valueOf", valueOfSignature, true);
+    box.unbox = env_util::getMethodId(env, clazz, unboxMethod, std::string("()") + primitiveSignature, false);
+    box.clazz = (jclass)env->NewGlobalRef(clazz);
+  } catch (const JniException &e) {
+    e.log();
+  }
+  if (clazz) {
+    env->DeleteLocalRef(clazz);
+  }
+  return box;
+}
+
+// java.lang boxes are loaded by the boot class loader, so the global class refs are simply kept for the process lifetime.
+template <typename T> const BoxClass &getBoxClass(JNIEnv *env) JNICPP11_THROWS(JniException) {
+  typedef BoxTraits<T> Traits;
+  static const BoxClass box = resolveBoxClass(env, Traits::classPath, Traits::primitiveSignature, Traits::unboxMethod);
+  if (box.clazz == nullptr) {
+    throw JniException(std::string("Failed to resolve boxed type ") + Traits::classPath);
+  }
+  return box;
+}
+
+template <typename T> jobject box(JNIEnv *env, const Boxed<T> &value) JNICPP11_THROWS(JniException) {
+  if (!value) {
+    return nullptr;
+  }
+  const BoxClass &box = getBoxClass<T>(env);
+  return env->CallStaticObjectMethod(box.clazz, box.valueOf, *value);
+}
+
+// Takes ownership of the local reference obj.
+template <typename T> Boxed<T> unbox(JNIEnv *env, jobject obj) JNICPP11_THROWS(JniException) {
+  if (obj == nullptr) {
+    return Boxed<T>();
+  }
+  const BoxClass &box = getBoxClass<T>(env);
+  T value = BoxTraits<T>::unbox(env, obj, box.unbox);
+  env->DeleteLocalRef(obj);
+  return Boxed<T>(value);
+}
+}
+
+#define BOXED_SPEC(TYPE)                                                                                                    \
+  template <> std::string TypeSignature::get<Boxed<TYPE>>() { return std::string("L") + BoxTraits<TYPE>::classPath + ";"; } \
+  template <> JavaObject makeArg(const Boxed<TYPE> &arg) {                                                                  \
+    JNIEnv *env = Jni::getEnv();                                                                                            \
+    if (env == nullptr) {                                                                                                   \
+      return nullptr;                                                                                                       \
+    }                                                                                                                       \
+    try {                                                                                                                   \
+      jobject jboxed = box<TYPE>(env, arg);                                                                                 \
+      JniException::checkException(env);                                                                                    \
+      return JavaObject(jboxed);                                                                                            \
+    } catch (const JniException &e) {                                                                                       \
+      e.log();                                                                                                              \
+    }                                                                                                                       \
+    return nullptr;                                                                                                         \
+  }                                                                                                                         \
+  template <> Boxed<TYPE> JavaObject::__call(JNIEnv *env, jmethodID methodId, ...) const {                                  \
+    va_list args;                                                                                                           \
+    va_start(args, methodId);                                                                                               \
+    jobject jret = env->CallObjectMethodV(_jobject.get(), methodId, args);                                                  \
+    va_end(args);                                                                                                           \
+    JniException::checkException(env);                                                                                      \
+    return unbox<TYPE>(env, jret);                                                                                          \
+  }                                                                                                                         \
+  template <> Boxed<TYPE> JavaClass::__staticCall(JNIEnv *env, jmethodID methodId, ...) const {                             \
+    va_list args;                                                                                                           \
+    va_start(args, methodId);                                                                                               \
+    jobject jret = env->CallStaticObjectMethodV(getJClass(), methodId, args);                                             \
+    va_end(args);                                                                                                           \
+    JniException::checkException(env);                                                                                      \
+    return unbox<TYPE>(env, jret);                                                                                          \
+  }                                                                                                                         \
+  template <> Boxed<TYPE> JavaObject::_field(JNIEnv *env, jfieldID fieldId) const {                                         \
+    return unbox<TYPE>(env, env->GetObjectField(_jobject.get(), fieldId));                                                  \
+  }                                                                                                                         \
+  template <> Boxed<TYPE> JavaClass::_staticField(JNIEnv *env, jfieldID fieldId) const {                                    \
+    return unbox<TYPE>(env, env->GetStaticObjectField(getJClass(), fieldId));                                             \
+  }                                                                                                                         \
+  template <> Boxed<TYPE> JavaField<Boxed<TYPE>>::_get(JNIEnv *env, jobject obj, jfieldID fieldId) {                        \
+    return unbox<TYPE>(env, env->GetObjectField(obj, fieldId));                                                             \
+  }                                                                                                                         \
+  template <> void JavaField<Boxed<TYPE>>::_set(JNIEnv *env, jobject obj, jfieldID fieldId, const Boxed<TYPE> &value) {     \
+    jobject jvalue = box<TYPE>(env, value);                                                                                 \
+    JniException::checkException(env);                                                                                      \
+    env->SetObjectField(obj, fieldId, jvalue);                                                                              \
+    env->DeleteLocalRef(jvalue);                                                                                            \
+  }                                                                                                                         \
+  template <> Boxed<TYPE> JavaStaticField<Boxed<TYPE>>::_get(JNIEnv *env, jclass clazz, jfieldID fieldId) {                 \
+    return unbox<TYPE>(env, env->GetStaticObjectField(clazz, fieldId));                                                     \
+  }                                                                                                                         \
+  template <>                                                                                                               \
+  void JavaStaticField<Boxed<TYPE>>::_set(JNIEnv *env, jclass clazz, jfieldID fieldId, const Boxed<TYPE> &value) {          \
+    jobject jvalue = box<TYPE>(env, value);                                                                                 \
+    JniException::checkException(env);                                                                                      \
+    env->SetStaticObjectField(clazz, fieldId, jvalue);                                                                      \
+    env->DeleteLocalRef(jvalue);                                                                                            \
+  }
+
+BOXED_SPEC(bool);
+BOXED_SPEC(jboolean);
+BOXED_SPEC(jbyte);
+BOXED_SPEC(jchar);
+BOXED_SPEC(jshort);
+BOXED_SPEC(jint);
+BOXED_SPEC(jlong);
+BOXED_SPEC(jfloat);
+BOXED_SPEC(jdouble);
+
 #pragma mark - Make Arg
 jobject adaptArg(const JavaObject &javaObject) { return javaObject.getJObject(); }
 
 JavaObject makeArg(const std::string &str) { return toJString(str); }
 
 namespace env_util {
-jclass findClass(JNIEnv *env, const std::string &classPath) throw(JniException) {
+jclass findClass(JNIEnv *env, const std::string &classPath) JNICPP11_THROWS(JniException) {
+  JNICPP11_TRACE_SPAN("findClass", classPath);
   jclass clazz = env->FindClass(classPath.c_str());
   if (clazz == nullptr) {
+    // the pending NoClassDefFoundError is reported as the JniException instead, so that callers can go on using JNI
+    env->ExceptionClear();
     throw JniException("Class not found: " + classPath);
   }
   JniException::checkException(env);
   return clazz;
 }
 
-jmethodID getMethodId(
-    JNIEnv *env, jclass clazz, const std::string &methodName, const std::string &signature, bool isStatic) throw(JniException) {
+jmethodID getMethodId(JNIEnv *env, jclass clazz, const std::string &methodName, const std::string &signature, bool isStatic)
+    JNICPP11_THROWS(JniException) {
+  JNICPP11_TRACE_SPAN("getMethodId", methodName);
   jmethodID methodId = nullptr;
   if (isStatic) {
     methodId = env->GetStaticMethodID(clazz, methodName.c_str(), signature.c_str());
@@ -557,8 +1261,9 @@ jmethodID getMethodId(
   return methodId;
 }
 
-jfieldID getFieldId(JNIEnv *env, jclass clazz, const std::string &fieldName, const std::string &signature, bool isStatic) throw(
-    JniException) {
+jfieldID getFieldId(JNIEnv *env, jclass clazz, const std::string &fieldName, const std::string &signature, bool isStatic)
+    JNICPP11_THROWS(JniException) {
+  JNICPP11_TRACE_SPAN("getFieldId", fieldName);
   jfieldID fieldId = nullptr;
   if (isStatic) {
     fieldId = env->GetStaticFieldID(clazz, fieldName.c_str(), signature.c_str());
@@ -573,5 +1278,209 @@ jfieldID getFieldId(JNIEnv *env, jclass clazz, const std::string &fieldName, con
   JniException::checkException(env);
   return fieldId;
 }
+
+void checkMethodId(jmethodID methodId) JNICPP11_THROWS(JniException) {
+#if JNICPP11_VALIDATION >= JNICPP11_VALIDATION_DEFAULT
+  if (methodId == nullptr) {
+    throw JniException("Method is not resolved.");
+  }
+#endif
+}
+
+void checkReference(JNIEnv *env, const JavaObject &obj) JNICPP11_THROWS(JniException) {
+  jobject jobj = obj.getJObject();
+  if (jobj == nullptr) {
+    return;
+  }
+  // borrowed and global references carry no owner
+  const LocalRefDeleter *deleter = std::get_deleter<LocalRefDeleter>(obj._jobject);
+  if (deleter && deleter->owner != env) {
+    throw JniException("Local reference used on a thread other than the one that created it.");
+  }
+  // only catches what the VM can tell from the reference itself; ART reports deleted references reliably only with
+  // CheckJNI enabled
+  if (env->GetObjectRefType(jobj) == JNIInvalidRefType) {
+    throw JniException("Invalid reference.");
+  }
+}
+
+void checkInstanceOf(JNIEnv *env, jobject obj, jclass clazz) JNICPP11_THROWS(JniException) {
+  if (clazz != nullptr && !env->IsInstanceOf(obj, clazz)) {
+    throw JniException("Object is not an instance of the member's class.");
+  }
+}
+
+// Converts Class.getName() ("int", "java.lang.String", "[Ljava.lang.String;") to a type signature.
+static std::string classNameToSignature(const std::string &className) {
+  static const char *const primitives[][2] = {{"boolean", "Z"}, {"byte", "B"},  {"char", "C"},   {"short", "S"}, {"int", "I"},
+                                              {"long", "J"},    {"float", "F"}, {"double", "D"}, {"void", "V"}};
+  for (const auto &primitive : primitives) {
+    if (className == primitive[0]) {
+      return primitive[1];
+    }
+  }
+  std::string signature = className[0] == '[' ? className : "L" + className + ";";
+  std::replace(signature.begin(), signature.end(), '.', '/');
+  return signature;
+}
+
+// Reference types only have to agree on being a reference (or an array of the same depth), since JavaObject
+// arguments and results carry no precise class at compile time.
+static bool signatureMatches(const std::string &expected, const std::string &actual) {
+  if (expected.empty() || actual.empty()) {
+    return false;
+  }
+  switch (expected[0]) {
+    case 'L':
+      return actual[0] == 'L' || actual[0] == '[';
+    case '[':
+      return actual[0] == '[' && signatureMatches(expected.substr(1), actual.substr(1));
+    default:
+      return expected == actual;
+  }
+}
+
+static std::vector<std::string> splitSignatures(const std::string &signatures) {
+  std::vector<std::string> result;
+  size_t begin = 0;
+  while (begin < signatures.size()) {
+    size_t end = begin;
+    while (end < signatures.size() && signatures[end] == '[') {
+      ++end;
+    }
+    end = signatures[end] == 'L' ? signatures.find(';', end) + 1 : end + 1;
+    result.push_back(signatures.substr(begin, end - begin));
+    begin = end;
+  }
+  return result;
+}
+
+void checkMethodSignature(JNIEnv *env, jclass clazz, jmethodID methodId, bool isStatic, const std::string &signature)
+    JNICPP11_THROWS(JniException) {
+  JavaObject method(env->ToReflectedMethod(clazz, methodId, isStatic));
+  JniException::checkException(env);
+  if (method == nullptr) {
+    throw JniException("ToReflectedMethod failed for " + signature);
+  }
+  jclass constructorClass = env_util::findClass(env, "java/lang/reflect/Constructor");
+  bool isConstructor = env->IsInstanceOf(method.getJObject(), constructorClass);
+  env->DeleteLocalRef(constructorClass);
+
+  std::vector<std::string> actual;
+  jobjectArray parameterTypes = (jobjectArray)env->CallObjectMethod(
+      method.getJObject(), env_util::getMethodId(env, method.getJClass(), "getParameterTypes", "()[Ljava/lang/Class;", false));
+  JniException::checkException(env);
+  jsize count = parameterTypes ? env->GetArrayLength(parameterTypes) : 0;
+  for (jsize i = 0; i < count; ++i) {
+    JavaObject type(env->GetObjectArrayElement(parameterTypes, i), "java/lang/Class");
+    actual.push_back(classNameToSignature(type.call<std::string>("getName", "")));
+  }
+  env->DeleteLocalRef(parameterTypes);
+  std::string actualReturn = "V";
+  if (!isConstructor) {
+    JavaObject returnType = method.call<JavaObject>("getReturnType", JavaObject::null("java/lang/Class"));
+    actualReturn = classNameToSignature(returnType.call<std::string>("getName", ""));
+  }
+
+  size_t close = signature.find(')');
+  std::vector<std::string> expected = splitSignatures(signature.substr(1, close - 1));
+  bool matches = expected.size() == actual.size() && signatureMatches(signature.substr(close + 1), actualReturn);
+  for (size_t i = 0; matches && i < expected.size(); ++i) {
+    matches = signatureMatches(expected[i], actual[i]);
+  }
+  if (!matches) {
+    std::ostringstream os;
+    os << "Method signature mismatch: called as `" << signature << "`, declared as `(";
+    for (const std::string &type : actual) {
+      os << type;
+    }
+    os << ")" << actualReturn << "`.";
+    throw JniException(os.str());
+  }
+}
+
+jfieldID checkFieldType(const JavaClass &clazz, jfieldID fieldId, bool isStatic, const std::string &accessSignature) {
+  JNIEnv *env = Jni::getEnv();
+  jclass jclazz = clazz.getJClass();
+  if (fieldId == nullptr || env == nullptr || jclazz == nullptr) {
+    return fieldId;
+  }
+  try {
+    JavaObject field(env->ToReflectedField(jclazz, fieldId, isStatic));
+    JniException::checkException(env);
+    if (field == nullptr) {
+      throw JniException("ToReflectedField failed.");
+    }
+    JavaObject type = field.call<JavaObject>("getType", JavaObject::null("java/lang/Class"));
+    std::string declared = classNameToSignature(type.call<std::string>("getName", ""));
+    if (!signatureMatches(accessSignature, declared)) {
+      throw JniException("Field type mismatch: accessed as `" + accessSignature + "`, declared as `" + declared + "`.");
+    }
+    return fieldId;
+  } catch (const JniException &e) {
+    e.log();
+  }
+  return nullptr;
+}
+
+jfieldID resolveFieldId(const JavaClass &clazz, const std::string &fieldName, const std::string &signature, bool isStatic) {
+  JNIEnv *env = Jni::getEnv();
+  if (env == nullptr) {
+    LOGE("Failed to get JNIEnv.");
+    return nullptr;
+  }
+  jclass jclazz = clazz.getJClass();
+  if (jclazz == nullptr) {
+    LOGE("Failed to get jclass.");
+    return nullptr;
+  }
+  try {
+    return getFieldId(env, jclazz, fieldName, signature, isStatic);
+  } catch (const JniException &e) {
+    e.log();
+  }
+  return nullptr;
+}
+}
+
+#pragma mark - Bindings
+
+bool resolveBindings(const JavaClassBinding *classes, size_t count) {
+  JNIEnv *env = Jni::getEnv();
+  if (env == nullptr) {
+    LOGE("Failed to get JNIEnv.");
+    return false;
+  }
+  bool resolved = true;
+  for (size_t i = 0; i < count; ++i) {
+    const JavaClassBinding &binding = classes[i];
+    jclass clazz = binding.javaClass().getJClass();
+    if (clazz == nullptr) {
+      LOGE("Class not found: %s", binding.classPath);
+      resolved = false;
+      continue;
+    }
+    for (size_t j = 0; j < binding.memberCount; ++j) {
+      const JavaMemberBinding &member = binding.members[j];
+      try {
+        switch (member.kind) {
+          case JavaMemberBinding::Method:
+          case JavaMemberBinding::StaticMethod:
+            *member.methodId = env_util::getMethodId(
+                env, clazz, member.name, member.signature, member.kind == JavaMemberBinding::StaticMethod);
+            break;
+          case JavaMemberBinding::Field:
+          case JavaMemberBinding::StaticField:
+            *member.fieldId =
+                env_util::getFieldId(env, clazz, member.name, member.signature, member.kind == JavaMemberBinding::StaticField);
+            break;
+        }
+      } catch (const JniException &e) {
+        LOGE("%s: %s", binding.classPath, e.what());
+        resolved = false;
+      }
+    }
+  }
+  return resolved;
 }
 }  // namespace jnicpp11
@@ -1,12 +1,46 @@
 #pragma once
 
+#include <atomic>
 #include <exception>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #include <jni.h>
 
+#include "JniCpp11Convert.h"
+#include "JniCpp11Trace.h"
+
+// Dynamic exception specifications are only kept as documentation before C++17, which removed them.
+#if __cplusplus >= 201703L
+#define JNICPP11_THROWS(...)
+#else
+#define JNICPP11_THROWS(...) throw(__VA_ARGS__)
+#endif
+
+/**
+ *  Per-call validation, chosen at build time with -DJNICPP11_VALIDATION=<level>. Use the same level for every
+ *  translation unit, including JniCpp11.cpp.
+ *
+ *  JNICPP11_VALIDATION_RELEASE  only the JNI exception check after each call; the caller guarantees valid
+ *                               env, objects and IDs. Array bounds are still checked.
+ *  JNICPP11_VALIDATION_DEFAULT  null checks on env, class, object and member IDs (the default).
+ *  JNICPP11_VALIDATION_STRICT   additionally rejects local references owned by a JavaObject and used on a thread
+ *                               other than their creator's, and references the VM reports as invalid (a deleted
+ *                               reference is only caught reliably with CheckJNI). Checks jmethodID calls against the
+ *                               argument and return types at the call site, and field handles against the declared
+ *                               field type. Meant for debug and test builds.
+ */
+#define JNICPP11_VALIDATION_RELEASE 0
+#define JNICPP11_VALIDATION_DEFAULT 1
+#define JNICPP11_VALIDATION_STRICT 2
+
+#ifndef JNICPP11_VALIDATION
+#define JNICPP11_VALIDATION JNICPP11_VALIDATION_DEFAULT
+#endif
+
 #define CONCAT(A, B, C) A##B##C
 #define JNI_FUNC(JAVA_CLASS, METHOD) JNIEXPORT void JNICALL CONCAT(JAVA_CLASS, _, METHOD)
 
@@ -36,7 +70,7 @@ class Jni {
 
 class JniException : public std::exception {
  public:
-  static void checkException(JNIEnv *env) throw(JniException);
+  static void checkException(JNIEnv *env) JNICPP11_THROWS(JniException);
 
   JniException(const std::string &message);
   ~JniException() noexcept override {}
@@ -48,11 +82,25 @@ class JniException : public std::exception {
 };
 
 class JavaObject;
+template <typename T> class JavaArray;
+
+namespace env_util {
+void checkReference(JNIEnv *env, const JavaObject &obj) JNICPP11_THROWS(JniException);
+}
 
 class JavaClass {
  public:
   static JavaClass getClass(const std::string &classPath);
-  virtual ~JavaClass() = default;
+  JavaClass(const JavaClass &other);
+  JavaClass(JavaClass &&other) noexcept;
+  JavaClass &operator=(const JavaClass &other);
+  JavaClass &operator=(JavaClass &&other) noexcept;
+  virtual ~JavaClass();
+
+  /**
+   *  Resolves the class lazily, once, on first use. Copies share the resolved class, and one JavaClass can be used
+   *  from several threads at the same time (but not assigned to while in use).
+   */
   jclass getJClass() const;
   std::string getTypeSignature() const;
   std::string getClassPath() const;
@@ -64,6 +112,14 @@ class JavaClass {
 
   template <typename... Args> void staticCallVoid(const std::string &methodName, Args... args) const;
 
+  // Overloads taking an already resolved jmethodID skip signature building and method lookup.
+  template <typename... Args> JavaObject newObject(jmethodID constructorId, Args... args) const;
+
+  template <typename ReturnType, typename... Args>
+  ReturnType staticCall(jmethodID methodId, const ReturnType &defaultValue, Args... args) const;
+
+  template <typename... Args> void staticCallVoid(jmethodID methodId, Args... args) const;
+
   template <typename ReturnType> ReturnType staticField(const std::string &fieldName, const ReturnType &defaultValue) const;
 
   operator bool() const;
@@ -72,8 +128,9 @@ class JavaClass {
 
  private:
   friend class JavaObject;
+  template <typename T> friend class JavaArray;
 
-  JNIEnv *checkAndGetEnv() const throw(JniException);
+  JNIEnv *checkAndGetEnv() const JNICPP11_THROWS(JniException);
   JavaClass(jclass clazz);
   JavaClass(const std::string &classPath);
   JavaClass(jclass clazz, const std::string &classPath);
@@ -86,8 +143,16 @@ class JavaClass {
 
   template <typename ReturnType> ReturnType _staticField(JNIEnv *env, jfieldID fieldId) const;
 
-  std::string _classPath;
-  shared_jclass _jclazz;
+  struct State;
+  static State *_newState(jclass clazz, const std::string &classPath);
+  State *_retainState() const;
+  static void _releaseState(State *state);
+  jclass _peekJClass() const;
+  bool _hasState() const;
+  // Publishes globalRef as the class if this JavaClass has none yet; returns the class that won.
+  jclass _publishJClass(jclass globalRef) const;
+
+  mutable std::atomic<State *> _state;
 };
 
 class JavaObject {
@@ -99,6 +164,13 @@ class JavaObject {
 
   static JavaObject null(const std::string &classPath);
 
+  /**
+   *  Wraps obj without taking ownership: the reference is neither deleted by this JavaObject nor by its copies.
+   *  Used when the reference is owned by someone else, e.g. a local frame.
+   */
+  static JavaObject borrow(jobject obj);
+  static JavaObject borrow(jobject obj, const JavaClass &clazz);
+
   virtual ~JavaObject() = default;
 
   jclass getJClass() const;
@@ -106,6 +178,12 @@ class JavaObject {
 
   JavaObject asType(const JavaClass &clazz) const;
 
+  /**
+   *  Returns a JavaObject backed by a new global reference, which can be kept beyond the current local frame
+   *  and used from other threads.
+   */
+  JavaObject toGlobalRef() const;
+
   virtual std::string getClassPath() const;
   virtual std::string getTypeSignature() const;
 
@@ -116,12 +194,18 @@ class JavaObject {
 
   template <typename... Args> void callVoid(const std::string &methodName, Args... args) const;
 
+  // Overloads taking an already resolved jmethodID skip signature building and method lookup.
+  template <typename ReturnType, typename... Args>
+  ReturnType call(jmethodID methodId, const ReturnType &defaultValue, Args... args) const;
+
+  template <typename... Args> void callVoid(jmethodID methodId, Args... args) const;
+
   operator bool() const;
 
   bool operator==(const std::nullptr_t &null) const;
 
  protected:
-  JNIEnv *checkAndGetEnv() const throw(JniException);
+  JNIEnv *checkAndGetEnv() const JNICPP11_THROWS(JniException);
 
   template <typename ReturnType> ReturnType _field(JNIEnv *env, jfieldID fieldId) const;
 
@@ -129,25 +213,168 @@ class JavaObject {
 
   template <typename ReturnType> ReturnType __call(JNIEnv *env, jmethodID methodId, ...) const;
 
+  friend void env_util::checkReference(JNIEnv *env, const JavaObject &obj) JNICPP11_THROWS(JniException);
+
   shared_jobject _jobject;
   JavaClass _javaClass;
 };
 
+/**
+ *  Primitive array, T being the JNI element type (jint, jfloat, ...).
+ *
+ *  from/copyTo convert between C++ element types and T as part of the copy, e.g. double -> jfloat,
+ *  Half -> jfloat, int64_t -> jint or std::vector<bool> -> jboolean.
+ */
 template <typename T> class JavaArray : public JavaObject {
  public:
+  JavaArray(jobject obj);
+  static JavaArray<T> null();
+
+  template <typename U> static JavaArray<T> from(const U *data, jsize size);
+  template <typename U> static JavaArray<T> from(const std::vector<U> &data);
+  // std::vector<bool> and bit-packed (LSB-first) overloads only compile for JavaArray<jboolean>.
+  static JavaArray<T> from(const std::vector<bool> &data);
+  static JavaArray<T> fromBits(const uint8_t *bits, jsize size);
+
   std::string getTypeSignature() const override;
+  jsize length() const;
+
+  template <typename U> bool copyTo(U *out, jsize offset, jsize size) const;
+  template <typename U> bool copyTo(std::vector<U> &out) const;
+  bool copyTo(std::vector<bool> &out) const;
+  bool copyToBits(uint8_t *bits, jsize offset, jsize size) const;
+
+ private:
+  JNIEnv *checkAndGetEnv(jsize offset, jsize size) const JNICPP11_THROWS(JniException);
+
+  static jarray _newArray(JNIEnv *env, jsize size);
+  static void _setRegion(JNIEnv *env, jarray array, jsize offset, jsize size, const T *data);
+  static void _getRegion(JNIEnv *env, jarray array, jsize offset, jsize size, T *out);
 };
 
+/**
+ *  Object array. The element class is either given on construction or taken from the array's runtime class
+ *  (Class.getComponentType) the first time it is needed.
+ *
+ *  auto files = dir.call("listFiles", JavaArray<JavaObject>::null("java/io/File"));
+ *  for (jsize i = 0; i < files.length(); ++i) {
+ *    JavaObject file = files.get(i);
+ *  }
+ *
+ *  Every get returns a new local reference. To scan a large array with a bounded number of local references,
+ *  use iterateArray from JniCpp11Iteration.h.
+ */
 template <> class JavaArray<JavaObject> : public JavaObject {
  public:
   JavaArray(jobject obj);
   JavaArray(jobject obj, const std::string &elementClassPath);
+  JavaArray(jobject obj, const JavaClass &elementClass);
   static JavaArray<JavaObject> null(const std::string &elementClassPath);
+
+  // Creates an array with one NewObjectArray call; null JavaObjects become null elements.
+  static JavaArray<JavaObject> from(const JavaObject *elements, jsize size, const JavaClass &elementClass);
+  static JavaArray<JavaObject> from(const std::vector<JavaObject> &elements, const JavaClass &elementClass);
+
+  jsize length() const;
+  JavaObject get(jsize index) const;
+  bool set(jsize index, const JavaObject &value) const;
+
   std::string getTypeSignature() const override;
   std::string getElementClassPath() const;
+  JavaClass getElementClass() const;
 
  private:
-  std::string _elementClassPath;
+  JNIEnv *checkAndGetEnv() const JNICPP11_THROWS(JniException);
+
+  JavaClass _elementClass;
+};
+
+/**
+ *  Instance field handle. The jfieldID is resolved once on construction and reused by every get/set.
+ *
+ *  JavaField<jint> score(clazz, "score");
+ *  score.set(player, score.get(player, 0) + 1);
+ *
+ *  For object fields other than std::string, pass the field type signature explicitly.
+ */
+template <typename T> class JavaField {
+ public:
+  JavaField(const JavaClass &clazz, const std::string &fieldName);
+  JavaField(const JavaClass &clazz, const std::string &fieldName, const std::string &signature);
+  JavaField(const JavaClass &clazz, jfieldID fieldId);
+
+  T get(const JavaObject &obj, const T &defaultValue) const;
+  void set(const JavaObject &obj, const T &value) const;
+
+  jfieldID getFieldId() const;
+  operator bool() const;
+
+ private:
+  JNIEnv *checkAndGetEnv(const JavaObject &obj) const JNICPP11_THROWS(JniException);
+
+  static T _get(JNIEnv *env, jobject obj, jfieldID fieldId);
+  static void _set(JNIEnv *env, jobject obj, jfieldID fieldId, const T &value);
+
+  JavaClass _javaClass;
+  jfieldID _fieldId = nullptr;
+};
+
+/**
+ *  Static field handle. The jfieldID is resolved once on construction and reused by every get/set.
+ */
+template <typename T> class JavaStaticField {
+ public:
+  JavaStaticField(const JavaClass &clazz, const std::string &fieldName);
+  JavaStaticField(const JavaClass &clazz, const std::string &fieldName, const std::string &signature);
+  JavaStaticField(const JavaClass &clazz, jfieldID fieldId);
+
+  T get(const T &defaultValue) const;
+  void set(const T &value) const;
+
+  jfieldID getFieldId() const;
+  operator bool() const;
+
+ private:
+  JNIEnv *checkAndGetEnv() const JNICPP11_THROWS(JniException);
+
+  static T _get(JNIEnv *env, jclass clazz, jfieldID fieldId);
+  static void _set(JNIEnv *env, jclass clazz, jfieldID fieldId, const T &value);
+
+  JavaClass _javaClass;
+  jfieldID _fieldId = nullptr;
+};
+
+#pragma mark - Boxed
+
+/**
+ *  Value of a Java boxed type (Boolean, Byte, Character, Short, Integer, Long, Float, Double), where an empty
+ *  Boxed stands for null. Supported for T = bool, jboolean, jbyte, jchar, jshort, jint, jlong, jfloat, jdouble
+ *  as call/field return types, field handle types and call arguments.
+ *
+ *  Boxed<jint> timeout = config.call<Boxed<jint>>("getTimeout", Boxed<jint>());
+ *  int seconds = timeout.valueOr(30);
+ *
+ *  Boxing goes through cached valueOf IDs and unboxing through cached xxxValue IDs.
+ */
+template <typename T> class Boxed {
+ public:
+  Boxed() = default;
+  Boxed(const T &value) : _value(value), _hasValue(true) {}
+
+  bool hasValue() const { return _hasValue; }
+  explicit operator bool() const { return _hasValue; }
+  const T &value() const { return _value; }
+  const T &operator*() const { return _value; }
+  T valueOr(const T &fallback) const { return _hasValue ? _value : fallback; }
+
+  bool operator==(const Boxed<T> &other) const {
+    return _hasValue == other._hasValue && (!_hasValue || _value == other._value);
+  }
+  bool operator!=(const Boxed<T> &other) const { return !(*this == other); }
+
+ private:
+  T _value = T();
+  bool _hasValue = false;
 };
 
 #pragma mark - jstring cast methods
@@ -159,8 +386,13 @@ JavaObject toJString(const std::string &str);
 #pragma mark - makeArg, adaptArg
 
 JavaObject makeArg(const std::string &str);
+template <typename T> JavaObject makeArg(const Boxed<T> &arg);
 template <typename T> const T &makeArg(const T &arg) { return arg; }
-template <typename T> const T &adaptArg(const T &arg) { return arg; }
+// JavaObject and its subclasses (JavaArray, generated bindings) go through varargs as their jobject.
+template <typename T, typename std::enable_if<!std::is_base_of<JavaObject, T>::value, int>::type = 0>
+const T &adaptArg(const T &arg) {
+  return arg;
+}
 jobject adaptArg(const JavaObject &javaObject);
 
 #pragma mark - TypeSignature, MethodSignature
@@ -201,25 +433,93 @@ struct MethodSignature {
 
 #pragma mark - JniEnv utils
 namespace env_util {
-jclass findClass(JNIEnv *env, const std::string &classPath) throw(JniException);
+jclass findClass(JNIEnv *env, const std::string &classPath) JNICPP11_THROWS(JniException);
+
+jmethodID getMethodId(JNIEnv *env, jclass clazz, const std::string &methodName, const std::string &signature, bool isStatic)
+    JNICPP11_THROWS(JniException);
+
+jfieldID getFieldId(JNIEnv *env, jclass clazz, const std::string &fieldName, const std::string &signature, bool isStatic)
+    JNICPP11_THROWS(JniException);
 
-jmethodID getMethodId(
-    JNIEnv *env, jclass clazz, const std::string &methodName, const std::string &signature, bool isStatic) throw(JniException);
+jfieldID resolveFieldId(const JavaClass &clazz, const std::string &fieldName, const std::string &signature, bool isStatic);
 
-jfieldID getFieldId(JNIEnv *env, jclass clazz, const std::string &fieldName, const std::string &signature, bool isStatic) throw(
-    JniException);
+void checkMethodId(jmethodID methodId) JNICPP11_THROWS(JniException);
+
+// Strict validation helpers, see JNICPP11_VALIDATION.
+void checkReference(JNIEnv *env, const JavaObject &obj) JNICPP11_THROWS(JniException);
+void checkInstanceOf(JNIEnv *env, jobject obj, jclass clazz) JNICPP11_THROWS(JniException);
+void checkMethodSignature(JNIEnv *env, jclass clazz, jmethodID methodId, bool isStatic, const std::string &signature)
+    JNICPP11_THROWS(JniException);
+// Returns fieldId, or nullptr after logging when the field's declared type cannot be accessed as accessSignature.
+jfieldID checkFieldType(const JavaClass &clazz, jfieldID fieldId, bool isStatic, const std::string &accessSignature);
+
+// Signature a field handle of type T reads and writes, compared against the declared type in strict mode.
+template <typename T> struct FieldAccess {
+  static std::string signature() { return TypeSignature::get<T>(); }
+};
+template <> struct FieldAccess<JavaObject> {
+  static std::string signature() { return "Ljava/lang/Object;"; }
+};
+template <> struct FieldAccess<JavaArray<JavaObject>> {
+  static std::string signature() { return "[Ljava/lang/Object;"; }
+};
 }
 
+// The signature is only built in strict mode.
+#if JNICPP11_VALIDATION >= JNICPP11_VALIDATION_STRICT
+#define JNICPP11_CHECK_METHOD(ENV, CLAZZ, METHOD_ID, IS_STATIC, SIGNATURE)    \
+  env_util::checkMethodId(METHOD_ID);                                         \
+  env_util::checkMethodSignature(ENV, CLAZZ, METHOD_ID, IS_STATIC, SIGNATURE)
+#else
+#define JNICPP11_CHECK_METHOD(ENV, CLAZZ, METHOD_ID, IS_STATIC, SIGNATURE) env_util::checkMethodId(METHOD_ID)
+#endif
+
+#if JNICPP11_VALIDATION >= JNICPP11_VALIDATION_STRICT
+#define JNICPP11_CHECK_FIELD(CLAZZ, FIELD_ID, IS_STATIC, T) \
+  env_util::checkFieldType(CLAZZ, FIELD_ID, IS_STATIC, env_util::FieldAccess<T>::signature())
+#else
+#define JNICPP11_CHECK_FIELD(CLAZZ, FIELD_ID, IS_STATIC, T) (FIELD_ID)
+#endif
+
+#pragma mark - Bindings
+
+/**
+ *  Registration table for member IDs resolved up front, as emitted by tools/jnicpp11_bindgen.py.
+ *  Exactly one of methodId and fieldId is set, depending on kind.
+ */
+struct JavaMemberBinding {
+  enum Kind { Method, StaticMethod, Field, StaticField };
+  Kind kind;
+  const char *name;
+  const char *signature;
+  jmethodID *methodId;
+  jfieldID *fieldId;
+};
+
+struct JavaClassBinding {
+  const char *classPath;
+  const JavaClass &(*javaClass)();
+  const JavaMemberBinding *members;
+  size_t memberCount;
+};
+
+/**
+ *  Resolves every class and member in the table. Call it once at startup from a thread that can see the
+ *  application classes (e.g. JNI_OnLoad). Returns false if anything failed to resolve; failures are logged.
+ */
+bool resolveBindings(const JavaClassBinding *classes, size_t count);
+
 #pragma mark - JavaClass template methods
 
 template <typename... Args> JavaObject JavaClass::newObject(Args... args) const {
+  JNICPP11_TRACE_SPAN("newObject");
   JNIEnv *env = nullptr;
   try {
     constexpr const char *name = "<init>";
     env = checkAndGetEnv();
     std::string signature = MethodSignature::getVoid(args...);
     jmethodID methodId = env_util::getMethodId(env, getJClass(), name, signature, false);
-    JavaObject jinstance = _newObject(env, methodId, makeArg(args)...);
+    JavaObject jinstance = _newObject(env, methodId, adaptArg(makeArg(args))...);
     JniException::checkException(env);
     return jinstance;
   } catch (const JniException &e) {
@@ -230,6 +530,7 @@ template <typename... Args> JavaObject JavaClass::newObject(Args... args) const
 
 template <typename ReturnType>
 ReturnType JavaClass::staticField(const std::string &fieldName, const ReturnType &defaultValue) const {
+  JNICPP11_TRACE_SPAN("staticField", fieldName);
   JNIEnv *env = nullptr;
   try {
     env = checkAndGetEnv();
@@ -246,6 +547,7 @@ ReturnType JavaClass::staticField(const std::string &fieldName, const ReturnType
 
 template <typename ReturnType, typename... Args>
 ReturnType JavaClass::staticCall(const std::string &methodName, const ReturnType &defaultValue, Args... args) const {
+  JNICPP11_TRACE_SPAN("staticCall", methodName);
   JNIEnv *env = nullptr;
   try {
     env = checkAndGetEnv();
@@ -261,6 +563,7 @@ ReturnType JavaClass::staticCall(const std::string &methodName, const ReturnType
 }
 
 template <typename... Args> void JavaClass::staticCallVoid(const std::string &methodName, Args... args) const {
+  JNICPP11_TRACE_SPAN("staticCall", methodName);
   JNIEnv *env = nullptr;
   try {
     env = checkAndGetEnv();
@@ -273,6 +576,50 @@ template <typename... Args> void JavaClass::staticCallVoid(const std::string &me
   }
 }
 
+template <typename... Args> JavaObject JavaClass::newObject(jmethodID constructorId, Args... args) const {
+  JNICPP11_TRACE_SPAN("newObject");
+  JNIEnv *env = nullptr;
+  try {
+    env = checkAndGetEnv();
+    JNICPP11_CHECK_METHOD(env, getJClass(), constructorId, false, MethodSignature::getVoid(args...));
+    JavaObject jinstance = _newObject(env, constructorId, adaptArg(makeArg(args))...);
+    JniException::checkException(env);
+    return jinstance;
+  } catch (const JniException &e) {
+    e.log();
+  }
+  return nullptr;
+}
+
+template <typename ReturnType, typename... Args>
+ReturnType JavaClass::staticCall(jmethodID methodId, const ReturnType &defaultValue, Args... args) const {
+  JNICPP11_TRACE_SPAN("staticCall");
+  JNIEnv *env = nullptr;
+  try {
+    env = checkAndGetEnv();
+    JNICPP11_CHECK_METHOD(env, getJClass(), methodId, true, MethodSignature::get(defaultValue, args...));
+    auto result = _staticCall<ReturnType>(env, methodId, makeArg(args)...);
+    JniException::checkException(env);
+    return result;
+  } catch (const JniException &e) {
+    e.log();
+  }
+  return defaultValue;
+}
+
+template <typename... Args> void JavaClass::staticCallVoid(jmethodID methodId, Args... args) const {
+  JNICPP11_TRACE_SPAN("staticCall");
+  JNIEnv *env = nullptr;
+  try {
+    env = checkAndGetEnv();
+    JNICPP11_CHECK_METHOD(env, getJClass(), methodId, true, MethodSignature::getVoid(args...));
+    _staticCall<void>(env, methodId, makeArg(args)...);
+    JniException::checkException(env);
+  } catch (const JniException &e) {
+    e.log();
+  }
+}
+
 template <typename ReturnType, typename... Args>
 ReturnType JavaClass::_staticCall(JNIEnv *env, jmethodID methodId, Args... args) const {
   return __staticCall<ReturnType>(env, methodId, adaptArg(args)...);
@@ -281,6 +628,7 @@ ReturnType JavaClass::_staticCall(JNIEnv *env, jmethodID methodId, Args... args)
 #pragma mark - JavaObject template methods
 
 template <typename ReturnType> ReturnType JavaObject::field(const std::string &fieldName, const ReturnType &defaultValue) const {
+  JNICPP11_TRACE_SPAN("field", fieldName);
   JNIEnv *env = nullptr;
   try {
     env = checkAndGetEnv();
@@ -297,6 +645,7 @@ template <typename ReturnType> ReturnType JavaObject::field(const std::string &f
 
 template <typename ReturnType, typename... Args>
 ReturnType JavaObject::call(const std::string &methodName, const ReturnType &defaultValue, Args... args) const {
+  JNICPP11_TRACE_SPAN("call", methodName);
   JNIEnv *env = nullptr;
   try {
     env = checkAndGetEnv();
@@ -312,6 +661,7 @@ ReturnType JavaObject::call(const std::string &methodName, const ReturnType &def
 }
 
 template <typename... Args> void JavaObject::callVoid(const std::string &methodName, Args... args) const {
+  JNICPP11_TRACE_SPAN("call", methodName);
   JNIEnv *env = nullptr;
   try {
     env = checkAndGetEnv();
@@ -324,12 +674,286 @@ template <typename... Args> void JavaObject::callVoid(const std::string &methodN
   }
 }
 
+template <typename ReturnType, typename... Args>
+ReturnType JavaObject::call(jmethodID methodId, const ReturnType &defaultValue, Args... args) const {
+  JNICPP11_TRACE_SPAN("call");
+  JNIEnv *env = nullptr;
+  try {
+    env = checkAndGetEnv();
+    JNICPP11_CHECK_METHOD(env, getJClass(), methodId, false, MethodSignature::get(defaultValue, args...));
+    auto result = _call<ReturnType>(env, methodId, makeArg(args)...);
+    JniException::checkException(env);
+    return result;
+  } catch (const JniException &e) {
+    e.log();
+  }
+  return defaultValue;
+}
+
+template <typename... Args> void JavaObject::callVoid(jmethodID methodId, Args... args) const {
+  JNICPP11_TRACE_SPAN("call");
+  JNIEnv *env = nullptr;
+  try {
+    env = checkAndGetEnv();
+    JNICPP11_CHECK_METHOD(env, getJClass(), methodId, false, MethodSignature::getVoid(args...));
+    _call<void>(env, methodId, makeArg(args)...);
+    JniException::checkException(env);
+  } catch (const JniException &e) {
+    e.log();
+  }
+}
+
 template <typename ReturnType, typename... Args>
 ReturnType JavaObject::_call(JNIEnv *env, jmethodID methodId, Args... args) const {
   return __call<ReturnType>(env, methodId, adaptArg(args)...);
 }
 
 #pragma mark - JavaArray
+template <typename T> JavaArray<T>::JavaArray(jobject obj) : JavaObject(obj) {}
+
+template <typename T> JavaArray<T> JavaArray<T>::null() { return JavaArray<T>(nullptr); }
+
 template <typename T> std::string JavaArray<T>::getTypeSignature() const { return "[" + TypeSignature::get<T>(); }
 
+template <typename T> jsize JavaArray<T>::length() const {
+  JNIEnv *env = Jni::getEnv();
+  if (env == nullptr || getJObject() == nullptr) {
+    return 0;
+  }
+  return env->GetArrayLength((jarray)getJObject());
+}
+
+template <typename T> template <typename U> JavaArray<T> JavaArray<T>::from(const U *data, jsize size) {
+  typedef convert::Converter<U, T> Converter;
+  JNIEnv *env = Jni::getEnv();
+  if (env == nullptr) {
+    return nullptr;
+  }
+  jarray array = nullptr;
+  try {
+    array = _newArray(env, size);
+    if (array == nullptr) {
+      throw JniException("Failed to create array.");
+    }
+    if (Converter::isIdentity) {
+      _setRegion(env, array, 0, size, reinterpret_cast<const T *>(data));
+    } else if (size > 0) {
+      T *elements = static_cast<T *>(env->GetPrimitiveArrayCritical(array, nullptr));
+      if (elements == nullptr) {
+        throw JniException("GetPrimitiveArrayCritical failed.");
+      }
+      Converter::run(data, elements, size);
+      env->ReleasePrimitiveArrayCritical(array, elements, 0);
+    }
+    JniException::checkException(env);
+    return JavaArray<T>(array);
+  } catch (const JniException &e) {
+    e.log();
+    if (array) {
+      env->DeleteLocalRef(array);
+    }
+  }
+  return nullptr;
+}
+
+template <typename T> template <typename U> JavaArray<T> JavaArray<T>::from(const std::vector<U> &data) {
+  return from(data.data(), (jsize)data.size());
+}
+
+template <typename T> template <typename U> bool JavaArray<T>::copyTo(U *out, jsize offset, jsize size) const {
+  typedef convert::Converter<T, U> Converter;
+  JNIEnv *env = nullptr;
+  try {
+    env = checkAndGetEnv(offset, size);
+    jarray array = (jarray)getJObject();
+    if (Converter::isIdentity) {
+      _getRegion(env, array, offset, size, reinterpret_cast<T *>(out));
+    } else if (size > 0) {
+      T *elements = static_cast<T *>(env->GetPrimitiveArrayCritical(array, nullptr));
+      if (elements == nullptr) {
+        throw JniException("GetPrimitiveArrayCritical failed.");
+      }
+      Converter::run(elements + offset, out, size);
+      env->ReleasePrimitiveArrayCritical(array, elements, JNI_ABORT);
+    }
+    JniException::checkException(env);
+    return true;
+  } catch (const JniException &e) {
+    e.log();
+  }
+  return false;
+}
+
+template <typename T> template <typename U> bool JavaArray<T>::copyTo(std::vector<U> &out) const {
+  out.resize(length());
+  return copyTo(out.data(), 0, (jsize)out.size());
+}
+
+// only JavaArray<jboolean> (specialized in JniCpp11.cpp) supports the std::vector<bool> and bit-packed overloads
+template <typename T> JavaArray<T> JavaArray<T>::from(const std::vector<bool> &) {
+  static_assert(std::is_same<T, jboolean>::value, "std::vector<bool> is only supported by JavaArray<jboolean>.");
+  return null();
+}
+
+template <typename T> JavaArray<T> JavaArray<T>::fromBits(const uint8_t *, jsize) {
+  static_assert(std::is_same<T, jboolean>::value, "fromBits is only supported by JavaArray<jboolean>.");
+  return null();
+}
+
+template <typename T> bool JavaArray<T>::copyTo(std::vector<bool> &) const {
+  static_assert(std::is_same<T, jboolean>::value, "std::vector<bool> is only supported by JavaArray<jboolean>.");
+  return false;
+}
+
+template <typename T> bool JavaArray<T>::copyToBits(uint8_t *, jsize, jsize) const {
+  static_assert(std::is_same<T, jboolean>::value, "copyToBits is only supported by JavaArray<jboolean>.");
+  return false;
+}
+
+template <> JavaArray<jboolean> JavaArray<jboolean>::from(const std::vector<bool> &data);
+template <> JavaArray<jboolean> JavaArray<jboolean>::fromBits(const uint8_t *bits, jsize size);
+template <> bool JavaArray<jboolean>::copyTo(std::vector<bool> &out) const;
+template <> bool JavaArray<jboolean>::copyToBits(uint8_t *bits, jsize offset, jsize size) const;
+
+template <typename T> JNIEnv *JavaArray<T>::checkAndGetEnv(jsize offset, jsize size) const JNICPP11_THROWS(JniException) {
+  JNIEnv *env = Jni::getEnv();
+  jobject jobj = getJObject();
+#if JNICPP11_VALIDATION >= JNICPP11_VALIDATION_DEFAULT
+  if (env == nullptr) {
+    throw JniException("Failed to get JNIEnv.");
+  }
+  if (jobj == nullptr) {
+    throw JniException("Failed to get jobject. ");
+  }
+#endif
+#if JNICPP11_VALIDATION >= JNICPP11_VALIDATION_STRICT
+  env_util::checkReference(env, *this);
+#endif
+  // kept in every mode: the converting copies write through pinned memory
+  if (offset < 0 || size < 0 || offset + size > env->GetArrayLength((jarray)jobj)) {
+    throw JniException("Array region out of bounds.");
+  }
+  return env;
+}
+
+#pragma mark - JavaField, JavaStaticField
+template <typename T>
+JavaField<T>::JavaField(const JavaClass &clazz, const std::string &fieldName)
+    : JavaField(clazz, fieldName, TypeSignature::get<T>()) {}
+
+template <typename T>
+JavaField<T>::JavaField(const JavaClass &clazz, const std::string &fieldName, const std::string &signature)
+    : _javaClass(clazz),
+      _fieldId(JNICPP11_CHECK_FIELD(clazz, env_util::resolveFieldId(clazz, fieldName, signature, false), false, T)) {}
+
+template <typename T>
+JavaField<T>::JavaField(const JavaClass &clazz, jfieldID fieldId)
+    : _javaClass(clazz), _fieldId(JNICPP11_CHECK_FIELD(clazz, fieldId, false, T)) {}
+
+template <typename T> T JavaField<T>::get(const JavaObject &obj, const T &defaultValue) const {
+  JNICPP11_TRACE_SPAN("field");
+  JNIEnv *env = nullptr;
+  try {
+    env = checkAndGetEnv(obj);
+    auto result = _get(env, obj.getJObject(), _fieldId);
+    JniException::checkException(env);
+    return result;
+  } catch (const JniException &e) {
+    e.log();
+  }
+  return defaultValue;
+}
+
+template <typename T> void JavaField<T>::set(const JavaObject &obj, const T &value) const {
+  JNICPP11_TRACE_SPAN("field");
+  JNIEnv *env = nullptr;
+  try {
+    env = checkAndGetEnv(obj);
+    _set(env, obj.getJObject(), _fieldId, value);
+    JniException::checkException(env);
+  } catch (const JniException &e) {
+    e.log();
+  }
+}
+
+template <typename T> JNIEnv *JavaField<T>::checkAndGetEnv(const JavaObject &obj) const JNICPP11_THROWS(JniException) {
+  JNIEnv *env = Jni::getEnv();
+#if JNICPP11_VALIDATION >= JNICPP11_VALIDATION_DEFAULT
+  if (env == nullptr) {
+    throw JniException("Failed to get JNIEnv.");
+  }
+  if (_fieldId == nullptr) {
+    throw JniException("Field is not resolved.");
+  }
+  if (obj.getJObject() == nullptr) {
+    throw JniException("Failed to get jobject. ");
+  }
+#endif
+#if JNICPP11_VALIDATION >= JNICPP11_VALIDATION_STRICT
+  env_util::checkReference(env, obj);
+  env_util::checkInstanceOf(env, obj.getJObject(), _javaClass.getJClass());
+#endif
+  return env;
+}
+
+template <typename T> jfieldID JavaField<T>::getFieldId() const { return _fieldId; }
+
+template <typename T> JavaField<T>::operator bool() const { return _fieldId != nullptr; }
+
+template <typename T>
+JavaStaticField<T>::JavaStaticField(const JavaClass &clazz, const std::string &fieldName)
+    : JavaStaticField(clazz, fieldName, TypeSignature::get<T>()) {}
+
+template <typename T>
+JavaStaticField<T>::JavaStaticField(const JavaClass &clazz, const std::string &fieldName, const std::string &signature)
+    : _javaClass(clazz),
+      _fieldId(JNICPP11_CHECK_FIELD(clazz, env_util::resolveFieldId(clazz, fieldName, signature, true), true, T)) {}
+
+template <typename T>
+JavaStaticField<T>::JavaStaticField(const JavaClass &clazz, jfieldID fieldId)
+    : _javaClass(clazz), _fieldId(JNICPP11_CHECK_FIELD(clazz, fieldId, true, T)) {}
+
+template <typename T> T JavaStaticField<T>::get(const T &defaultValue) const {
+  JNICPP11_TRACE_SPAN("staticField");
+  JNIEnv *env = nullptr;
+  try {
+    env = checkAndGetEnv();
+    auto result = _get(env, _javaClass.getJClass(), _fieldId);
+    JniException::checkException(env);
+    return result;
+  } catch (const JniException &e) {
+    e.log();
+  }
+  return defaultValue;
+}
+
+template <typename T> void JavaStaticField<T>::set(const T &value) const {
+  JNICPP11_TRACE_SPAN("staticField");
+  JNIEnv *env = nullptr;
+  try {
+    env = checkAndGetEnv();
+    _set(env, _javaClass.getJClass(), _fieldId, value);
+    JniException::checkException(env);
+  } catch (const JniException &e) {
+    e.log();
+  }
+}
+
+template <typename T> JNIEnv *JavaStaticField<T>::checkAndGetEnv() const JNICPP11_THROWS(JniException) {
+  JNIEnv *env = Jni::getEnv();
+#if JNICPP11_VALIDATION >= JNICPP11_VALIDATION_DEFAULT
+  if (env == nullptr) {
+    throw JniException("Failed to get JNIEnv.");
+  }
+  if (_fieldId == nullptr) {
+    throw JniException("Field is not resolved.");
+  }
+#endif
+  return env;
+}
+
+template <typename T> jfieldID JavaStaticField<T>::getFieldId() const { return _fieldId; }
+
+template <typename T> JavaStaticField<T>::operator bool() const { return _fieldId != nullptr; }
+
 }  // namespace jnicpp11
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include "JniCpp11Async.h"
+
+#include <memory>
+
+namespace jnicpp11 {
+
+#pragma mark - NativeCompletion
+
+namespace {
+struct NativeCompletionClass {
+  jclass clazz = nullptr;
+  jmethodID whenComplete = nullptr;
+  jmethodID listener = nullptr;
+};
+
+NativeCompletionClass g_nativeCompletion;
+
+void JNICALL nativeComplete(JNIEnv *, jclass, jlong handle, jobject result, jobject error, jboolean failed) {
+  std::unique_ptr<JavaAsync::Callback> callback(reinterpret_cast<JavaAsync::Callback *>(handle));
+  JavaCompletion completion{JavaObject::borrow(result), JavaObject::borrow(error), failed == JNI_TRUE};
+  // exceptions must not unwind into the JVM
+  try {
+    (*callback)(completion);
+  } catch (const std::exception &e) {
+    JniException(std::string("JavaAsync callback threw: ") + e.what()).log();
+  } catch (...) {
+    JniException("JavaAsync callback threw.").log();
+  }
+}
+
+jlong toHandle(JavaAsync::Callback callback) { return reinterpret_cast<jlong>(new JavaAsync::Callback(std::move(callback))); }
+
+void deleteHandle(jlong handle) { delete reinterpret_cast<JavaAsync::Callback *>(handle); }
+
+JNIEnv *checkAndGetEnv() JNICPP11_THROWS(JniException) {
+  JNIEnv *env = Jni::getEnv();
+  if (env == nullptr) {
+    throw JniException("Failed to get JNIEnv.");
+  }
+  if (g_nativeCompletion.clazz == nullptr) {
+    throw JniException("JavaAsync::init has not been called.");
+  }
+  return env;
+}
+}
+
+#pragma mark - JavaAsync
+
+bool JavaAsync::init() {
+  if (g_nativeCompletion.clazz) {
+    return true;
+  }
+  JNIEnv *env = Jni::getEnv();
+  if (env == nullptr) {
+    return false;
+  }
+  jclass clazz = nullptr;
+  try {
+    clazz = env_util::findClass(env, "org/jnicpp11/NativeCompletion");
+    static const JNINativeMethod methods[] = {
+        {"nativeComplete", "(JLjava/lang/Object;Ljava/lang/Object;Z)V", reinterpret_cast<void *>(nativeComplete)},
+    };
+    if (env->RegisterNatives(clazz, methods, sizeof(methods) / sizeof(methods[0])) != JNI_OK) {
+      JniException::checkException(env);
+      throw JniException("RegisterNatives failed for org/jnicpp11/NativeCompletion.");
+    }
+    g_nativeCompletion.whenComplete =
+        env_util::getMethodId(env, clazz, "whenComplete", "(Ljava/util/concurrent/CompletionStage;J)V", true);
+    g_nativeCompletion.listener = env_util::getMethodId(
+        env, clazz, "listener", "(Ljava/lang/Class;Ljava/lang/String;Ljava/lang/String;J)Ljava/lang/Object;", true);
+    g_nativeCompletion.clazz = (jclass)env->NewGlobalRef(clazz);
+    env->DeleteLocalRef(clazz);
+    return g_nativeCompletion.clazz != nullptr;
+  } catch (const JniException &e) {
+    e.log();
+  }
+  if (clazz) {
+    env->DeleteLocalRef(clazz);
+  }
+  return false;
+}
+
+bool JavaAsync::then(const JavaObject &completionStage, Callback callback) {
+  JNIEnv *env = nullptr;
+  jlong handle = 0;
+  try {
+    env = checkAndGetEnv();
+    if (!completionStage) {
+      throw JniException("CompletionStage is null.");
+    }
+    handle = toHandle(std::move(callback));
+    env->CallStaticVoidMethod(
+        g_nativeCompletion.clazz, g_nativeCompletion.whenComplete, completionStage.getJObject(), handle);
+    JniException::checkException(env);
+    return true;
+  } catch (const JniException &e) {
+    e.log();
+    // the handle is only consumed by Java once whenComplete succeeded
+    deleteHandle(handle);
+  }
+  return false;
+}
+
+JavaObject JavaAsync::listener(const JavaClass &listenerInterface,
+                               const std::string &successMethod,
+                               const std::string &failureMethod,
+                               Callback callback) {
+  JNIEnv *env = nullptr;
+  jlong handle = 0;
+  try {
+    env = checkAndGetEnv();
+    if (listenerInterface.getJClass() == nullptr) {
+      throw JniException("Failed to get jclass.");
+    }
+    JavaObject success = toJString(successMethod);
+    JavaObject failure = failureMethod.empty() ? JavaObject(nullptr) : toJString(failureMethod);
+    handle = toHandle(std::move(callback));
+    jobject proxy = env->CallStaticObjectMethod(g_nativeCompletion.clazz,
+                                                g_nativeCompletion.listener,
+                                                listenerInterface.getJClass(),
+                                                success.getJObject(),
+                                                failure.getJObject(),
+                                                handle);
+    JniException::checkException(env);
+    return JavaObject(proxy, listenerInterface);
+  } catch (const JniException &e) {
+    e.log();
+    deleteHandle(handle);
+  }
+  return nullptr;
+}
+
+std::future<JavaObject> JavaAsync::toFuture(const JavaObject &completionStage) {
+  auto promise = std::make_shared<std::promise<JavaObject>>();
+  std::future<JavaObject> future = promise->get_future();
+  bool registered = then(completionStage, [promise](const JavaCompletion &completion) {
+    if (completion.failed) {
+      promise->set_exception(std::make_exception_ptr(JniException(describeError(completion))));
+    } else {
+      promise->set_value(completion.result.toGlobalRef());
+    }
+  });
+  if (!registered) {
+    promise->set_exception(std::make_exception_ptr(JniException("Failed to observe CompletionStage.")));
+  }
+  return future;
+}
+
+std::string JavaAsync::describeError(const JavaCompletion &completion) {
+  if (!completion.failed) {
+    return "";
+  }
+  if (!completion.error) {
+    return "Java async operation failed.";
+  }
+  return "Java async operation failed: " + completion.error.call<std::string>("toString", "");
+}
+}  // namespace jnicpp11
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <functional>
+#include <future>
+
+#include "JniCpp11.h"
+
+namespace jnicpp11 {
+
+/**
+ *  Outcome of a Java async operation. error is the Throwable of a failed CompletionStage, or the first argument
+ *  of the failure method of a listener.
+ */
+struct JavaCompletion {
+  JavaObject result;
+  JavaObject error;
+  bool failed;
+};
+
+/**
+ *  Bridges Java async results into C++ without blocking a thread per operation: completion is delivered by a
+ *  native callback running on the Java thread that completes the operation.
+ *
+ *  Requires java/org/jnicpp11/NativeCompletion.java to be compiled into the app, and JavaAsync::init() to be
+ *  called from a thread that can see application classes:
+ *
+ *  jint JNI_OnLoad(JavaVM *vm, void *reserved) {
+ *    Jni::setJvm(vm);
+ *    JavaAsync::init();
+ *    return JNI_VERSION_1_6;
+ *  }
+ *
+ *  A callback that never completes on the Java side is never released.
+ */
+class JavaAsync {
+ public:
+  typedef std::function<void(const JavaCompletion &completion)> Callback;
+
+  static bool init();
+
+  /**
+   *  Calls callback once completionStage (a java.util.concurrent.CompletionStage, e.g. CompletableFuture)
+   *  completes. The references in the completion are only valid during the callback; use
+   *  JavaObject::toGlobalRef to keep them.
+   */
+  static bool then(const JavaObject &completionStage, Callback callback);
+
+  /**
+   *  Creates an implementation of listenerInterface that calls callback the first time successMethod or
+   *  failureMethod is invoked. failureMethod can be empty.
+   */
+  static JavaObject listener(const JavaClass &listenerInterface,
+                             const std::string &successMethod,
+                             const std::string &failureMethod,
+                             Callback callback);
+
+  /**
+   *  Returns a future that holds a global reference to the result, or a JniException if the stage failed.
+   */
+  static std::future<JavaObject> toFuture(const JavaObject &completionStage);
+
+  static std::string describeError(const JavaCompletion &completion);
+};
+}  // namespace jnicpp11
@@ -0,0 +1,163 @@
+#include "JniCpp11Batch.h"
+
+namespace jnicpp11 {
+
+#pragma mark - CommandBatch
+
+namespace {
+struct CommandBatchClass {
+  jclass clazz = nullptr;
+  jmethodID constructor = nullptr;
+  jmethodID addTarget = nullptr;
+  jmethodID addMethod = nullptr;
+  jmethodID execute = nullptr;
+};
+
+CommandBatchClass g_commandBatch;
+
+JNIEnv *checkAndGetEnv() JNICPP11_THROWS(JniException) {
+  JNIEnv *env = Jni::getEnv();
+  if (env == nullptr) {
+    throw JniException("Failed to get JNIEnv.");
+  }
+  if (g_commandBatch.clazz == nullptr) {
+    throw JniException("JavaCommandBatch::init has not been called.");
+  }
+  return env;
+}
+}
+
+#pragma mark - JavaCommandBatch
+
+bool JavaCommandBatch::init() {
+  if (g_commandBatch.clazz) {
+    return true;
+  }
+  JNIEnv *env = Jni::getEnv();
+  if (env == nullptr) {
+    return false;
+  }
+  jclass clazz = nullptr;
+  try {
+    clazz = env_util::findClass(env, "org/jnicpp11/CommandBatch");
+    g_commandBatch.constructor = env_util::getMethodId(env, clazz, "<init>", "(Ljava/nio/ByteBuffer;)V", false);
+    g_commandBatch.addTarget = env_util::getMethodId(env, clazz, "addTarget", "(Ljava/lang/Object;)I", false);
+    g_commandBatch.addMethod = env_util::getMethodId(env, clazz, "addMethod", "(Ljava/lang/reflect/Method;)I", false);
+    g_commandBatch.execute = env_util::getMethodId(env, clazz, "execute", "(I)Ljava/lang/String;", false);
+    g_commandBatch.clazz = (jclass)env->NewGlobalRef(clazz);
+    env->DeleteLocalRef(clazz);
+    return g_commandBatch.clazz != nullptr;
+  } catch (const JniException &e) {
+    e.log();
+  }
+  if (clazz) {
+    env->DeleteLocalRef(clazz);
+  }
+  return false;
+}
+
+JavaCommandBatch::JavaCommandBatch(size_t capacity) : _buffer(capacity) {
+  JNIEnv *env = nullptr;
+  try {
+    env = checkAndGetEnv();
+    JavaObject byteBuffer(env->NewDirectByteBuffer(_buffer.data(), (jlong)_buffer.size()));
+    JniException::checkException(env);
+    if (!byteBuffer) {
+      throw JniException("NewDirectByteBuffer failed; direct buffer access is not supported by this JVM.");
+    }
+    JavaObject batch(env->NewObject(g_commandBatch.clazz, g_commandBatch.constructor, byteBuffer.getJObject()));
+    JniException::checkException(env);
+    _batch = batch.toGlobalRef();
+  } catch (const JniException &e) {
+    e.log();
+  }
+}
+
+JavaCommandBatch::Target JavaCommandBatch::addTarget(const JavaObject &target) {
+  JNIEnv *env = nullptr;
+  try {
+    env = checkAndGetEnv();
+    if (!_batch) {
+      throw JniException("JavaCommandBatch was not created.");
+    }
+    jint index = env->CallIntMethod(_batch.getJObject(), g_commandBatch.addTarget, target.getJObject());
+    JniException::checkException(env);
+    return Target{index};
+  } catch (const JniException &e) {
+    e.log();
+  }
+  return Target{-1};
+}
+
+JavaCommandBatch::Method JavaCommandBatch::addMethod(const JavaClass &clazz,
+                                                     const std::string &methodName,
+                                                     const std::string &signature) {
+  return _addMethod(clazz, methodName, signature, false);
+}
+
+JavaCommandBatch::Method JavaCommandBatch::addStaticMethod(const JavaClass &clazz,
+                                                           const std::string &methodName,
+                                                           const std::string &signature) {
+  return _addMethod(clazz, methodName, signature, true);
+}
+
+JavaCommandBatch::Method JavaCommandBatch::_addMethod(const JavaClass &clazz,
+                                                      const std::string &methodName,
+                                                      const std::string &signature,
+                                                      bool isStatic) {
+  JNIEnv *env = nullptr;
+  try {
+    env = checkAndGetEnv();
+    if (!_batch) {
+      throw JniException("JavaCommandBatch was not created.");
+    }
+    jclass jclazz = clazz.getJClass();
+    if (jclazz == nullptr) {
+      throw JniException("Failed to get jclass.");
+    }
+    if (signature.empty() || signature[signature.size() - 1] != 'V') {
+      throw JniException("JavaCommandBatch only records void methods: " + methodName + signature);
+    }
+    jmethodID methodId = env_util::getMethodId(env, jclazz, methodName, signature, isStatic);
+    JavaObject method(env->ToReflectedMethod(jclazz, methodId, isStatic));
+    JniException::checkException(env);
+    if (!method) {
+      throw JniException("ToReflectedMethod failed for " + methodName + signature);
+    }
+    jint index = env->CallIntMethod(_batch.getJObject(), g_commandBatch.addMethod, method.getJObject());
+    JniException::checkException(env);
+    return Method{index};
+  } catch (const JniException &e) {
+    e.log();
+  }
+  return Method{-1};
+}
+
+bool JavaCommandBatch::flush() {
+  if (_size == 0) {
+    return true;
+  }
+  JNICPP11_TRACE_SPAN("flushBatch");
+  jint length = (jint)_size;
+  _size = 0;
+  _commandCount = 0;
+  JNIEnv *env = nullptr;
+  try {
+    env = checkAndGetEnv();
+    if (!_batch) {
+      throw JniException("JavaCommandBatch was not created.");
+    }
+    JavaObject error(env->CallObjectMethod(_batch.getJObject(), g_commandBatch.execute, length));
+    JniException::checkException(env);
+    if (error) {
+      throw JniException(fromJString(error));
+    }
+    return true;
+  } catch (const JniException &e) {
+    e.log();
+  }
+  return false;
+}
+
+JavaCommandBatch::operator bool() const { return (bool)_batch; }
+}  // namespace jnicpp11
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "JniCpp11.h"
+
+namespace jnicpp11 {
+
+/**
+ *  Records many small void calls (e.g. setters on views) into a native buffer shared with Java as a direct
+ *  ByteBuffer, and runs all of them with a single JNI crossing on flush.
+ *
+ *  Requires java/org/jnicpp11/CommandBatch.java to be compiled into the app, and JavaCommandBatch::init() to be
+ *  called from a thread that can see application classes (e.g. JNI_OnLoad). With minSdkVersion 26 or higher, also
+ *  compile java/org/jnicpp11/MethodHandleInvoker.java so that primitive arguments are not boxed on the Java side.
+ *
+ *  JavaCommandBatch batch;
+ *  auto label = batch.addTarget(labelView);
+ *  auto setText = batch.addMethod(textViewClass, "setText", "(Ljava/lang/CharSequence;)V");
+ *  auto setAlpha = batch.addMethod(viewClass, "setAlpha", "(F)V");
+ *  ...
+ *  batch.callVoid(label, setText, std::string("Score: 42"));
+ *  batch.callVoid(label, setAlpha, 0.5f);
+ *  batch.flush();  // once per frame
+ *
+ *  Arguments can be bool, jboolean, jbyte, jchar, jshort, jint, jlong, jfloat, jdouble, std::string, const char * or
+ *  char * (a null pointer is passed as null), a Target (passed as the registered object) or nullptr; other types, such
+ *  as char, do not compile. Like Method.invoke, the dispatcher widens arguments to the parameter types (e.g. jint for a
+ *  long parameter) but never narrows them. A batch is flushed automatically when it is full. Targets and methods stay
+ *  registered for the lifetime of the batch. A batch is not thread-safe.
+ */
+class JavaCommandBatch {
+ public:
+  struct Target {
+    jint index;
+  };
+  struct Method {
+    jint index;
+  };
+
+  static bool init();
+
+  explicit JavaCommandBatch(size_t capacity = 64 * 1024);
+  JavaCommandBatch(const JavaCommandBatch &) = delete;
+  JavaCommandBatch &operator=(const JavaCommandBatch &) = delete;
+
+  // Registration goes straight to Java; the returned handles are only valid for this batch.
+  Target addTarget(const JavaObject &target);
+  Method addMethod(const JavaClass &clazz, const std::string &methodName, const std::string &signature);
+  Method addStaticMethod(const JavaClass &clazz, const std::string &methodName, const std::string &signature);
+
+  template <typename... Args> bool callVoid(Target target, Method method, Args... args);
+  template <typename... Args> bool staticCallVoid(Method method, Args... args);
+
+  // Runs and clears the recorded commands. Returns false if any of them failed; the first failure is logged.
+  bool flush();
+
+  size_t size() const { return _commandCount; }
+  operator bool() const;
+
+ private:
+  Method _addMethod(const JavaClass &clazz, const std::string &methodName, const std::string &signature, bool isStatic);
+  template <typename... Args> bool _record(jint target, Method method, Args... args);
+
+  template <typename T> void _put(const T &value) {
+    memcpy(_buffer.data() + _size, &value, sizeof(T));
+    _size += sizeof(T);
+  }
+  template <typename T> void _putArg(char tag, const T &value) {
+    _buffer[_size++] = tag;
+    _put(value);
+  }
+
+  static size_t _encodedSize() { return 0; }
+  template <typename T, typename... Ts> static size_t _encodedSize(const T &first, const Ts &... rest) {
+    return _argSize(first) + _encodedSize(rest...);
+  }
+  // One _argSize per _encodeArg, so that the size checked in _record is the size written. Other types (char, unsigned
+  // or enum values, pointers) would otherwise convert to an overload of a different size, so they do not compile.
+  static size_t _argSize(bool) { return 1 + sizeof(jboolean); }
+  static size_t _argSize(jboolean) { return 1 + sizeof(jboolean); }
+  static size_t _argSize(jbyte) { return 1 + sizeof(jbyte); }
+  static size_t _argSize(jchar) { return 1 + sizeof(jchar); }
+  static size_t _argSize(jshort) { return 1 + sizeof(jshort); }
+  static size_t _argSize(jint) { return 1 + sizeof(jint); }
+  static size_t _argSize(jlong) { return 1 + sizeof(jlong); }
+  static size_t _argSize(jfloat) { return 1 + sizeof(jfloat); }
+  static size_t _argSize(jdouble) { return 1 + sizeof(jdouble); }
+  static size_t _argSize(Target) { return 1 + sizeof(jint); }
+  static size_t _argSize(std::nullptr_t) { return 1; }
+  static size_t _argSize(const char *value) { return value ? 1 + sizeof(jint) + strlen(value) : 1; }
+  static size_t _argSize(char *value) { return _argSize((const char *)value); }
+  static size_t _argSize(const std::string &value) { return 1 + sizeof(jint) + value.size(); }
+  template <typename T> static size_t _argSize(T) = delete;
+
+  void _encode() {}
+  template <typename T, typename... Ts> void _encode(const T &first, const Ts &... rest) {
+    _encodeArg(first);
+    _encode(rest...);
+  }
+  void _encodeArg(bool value) { _putArg<jboolean>('Z', value ? JNI_TRUE : JNI_FALSE); }
+  void _encodeArg(jboolean value) { _putArg('Z', value); }
+  void _encodeArg(jbyte value) { _putArg('B', value); }
+  void _encodeArg(jchar value) { _putArg('C', value); }
+  void _encodeArg(jshort value) { _putArg('S', value); }
+  void _encodeArg(jint value) { _putArg('I', value); }
+  void _encodeArg(jlong value) { _putArg('J', value); }
+  void _encodeArg(jfloat value) { _putArg('F', value); }
+  void _encodeArg(jdouble value) { _putArg('D', value); }
+  void _encodeArg(Target value) { _putArg('O', value.index); }
+  void _encodeArg(std::nullptr_t) { _buffer[_size++] = 'N'; }
+  void _encodeArg(const char *value) {
+    if (value) {
+      _encodeString(value, strlen(value));
+    } else {
+      _encodeArg(nullptr);
+    }
+  }
+  void _encodeArg(char *value) { _encodeArg((const char *)value); }
+  void _encodeArg(const std::string &value) { _encodeString(value.data(), value.size()); }
+  template <typename T> void _encodeArg(T) = delete;
+  void _encodeString(const char *value, size_t length) {
+    _putArg('T', (jint)length);
+    memcpy(_buffer.data() + _size, value, length);
+    _size += length;
+  }
+
+  std::vector<char> _buffer;
+  size_t _size = 0;
+  size_t _commandCount = 0;
+  JavaObject _batch{nullptr};
+};
+
+#pragma mark - JavaCommandBatch template methods
+
+template <typename... Args> bool JavaCommandBatch::callVoid(Target target, Method method, Args... args) {
+  // -1 is the static call marker, so an unregistered target must not reach the buffer
+  if (target.index < 0) {
+    JniException("JavaCommandBatch: target was not registered.").log();
+    return false;
+  }
+  return _record(target.index, method, args...);
+}
+
+template <typename... Args> bool JavaCommandBatch::staticCallVoid(Method method, Args... args) {
+  return _record(-1, method, args...);
+}
+
+template <typename... Args> bool JavaCommandBatch::_record(jint target, Method method, Args... args) {
+  if (method.index < 0) {
+    JniException("JavaCommandBatch: method was not registered.").log();
+    return false;
+  }
+  size_t commandSize = 3 * sizeof(jint) + _encodedSize(args...);
+  if (_size + commandSize > _buffer.size()) {
+    flush();
+    if (commandSize > _buffer.size()) {
+      JniException("JavaCommandBatch: command larger than the batch capacity.").log();
+      return false;
+    }
+  }
+  _put(target);
+  _put(method.index);
+  _put((jint)sizeof...(args));
+  _encode(args...);
+  ++_commandCount;
+  return true;
+}
+}  // namespace jnicpp11
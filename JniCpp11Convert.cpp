@@ -0,0 +1,275 @@
+#include "JniCpp11Convert.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define JNICPP11_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define JNICPP11_SSE2 1
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+#endif
+
+namespace jnicpp11 {
+namespace convert {
+
+#pragma mark - scalar kernels
+namespace scalar {
+
+static inline uint32_t floatBits(float f) {
+  uint32_t bits;
+  std::memcpy(&bits, &f, sizeof(bits));
+  return bits;
+}
+
+static inline float bitsFloat(uint32_t bits) {
+  float f;
+  std::memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+void doubleToFloat(const jdouble *src, jfloat *dst, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    dst[i] = static_cast<jfloat>(src[i]);
+  }
+}
+
+void floatToDouble(const jfloat *src, jdouble *dst, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    dst[i] = static_cast<jdouble>(src[i]);
+  }
+}
+
+void halfToFloat(const Half *src, jfloat *dst, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    uint32_t h = src[i].bits;
+    uint32_t sign = (h & 0x8000u) << 16;
+    uint32_t exponent = (h >> 10) & 0x1fu;
+    uint32_t mantissa = h & 0x3ffu;
+    if (exponent == 0) {
+      // zero or subnormal: mantissa * 2^-24
+      float magnitude = static_cast<float>(mantissa) * (1.0f / 16777216.0f);
+      dst[i] = bitsFloat(sign | floatBits(magnitude));
+    } else if (exponent == 0x1f) {
+      // like the hardware conversions: NaNs keep their payload and become quiet
+      uint32_t quiet = mantissa ? 0x00400000u : 0u;
+      dst[i] = bitsFloat(sign | 0x7f800000u | quiet | (mantissa << 13));
+    } else {
+      dst[i] = bitsFloat(sign | ((exponent + 112) << 23) | (mantissa << 13));
+    }
+  }
+}
+
+// Rounds to nearest even, overflows to infinity and quiets NaNs, keeping the top bits of their payload.
+void floatToHalf(const jfloat *src, Half *dst, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    uint32_t bits = floatBits(src[i]);
+    uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+    uint32_t magnitude = bits & 0x7fffffffu;
+    uint16_t result;
+    if (magnitude >= 0x7f800000u) {
+      result = magnitude > 0x7f800000u ? static_cast<uint16_t>(0x7e00u | ((magnitude >> 13) & 0x3ffu)) : 0x7c00;
+    } else if (magnitude >= 0x477ff000u) {
+      // >= 65520 rounds to infinity
+      result = 0x7c00;
+    } else if (magnitude < 0x38800000u) {
+      // subnormal half: let the FPU round by aligning the mantissa against 0.5f
+      result = static_cast<uint16_t>(floatBits(bitsFloat(magnitude) + 0.5f) - 0x3f000000u);
+    } else {
+      uint32_t mantissaOdd = (magnitude >> 13) & 1u;
+      magnitude += 0xc8000fffu + mantissaOdd;
+      result = static_cast<uint16_t>(magnitude >> 13);
+    }
+    dst[i].bits = sign | result;
+  }
+}
+
+void int64ToInt32(const int64_t *src, jint *dst, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    dst[i] = static_cast<jint>(static_cast<uint32_t>(src[i]));
+  }
+}
+
+void int32ToInt64(const jint *src, int64_t *dst, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    dst[i] = src[i];
+  }
+}
+
+void unpackBits(const uint8_t *bits, jboolean *dst, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    dst[i] = (bits[i >> 3] >> (i & 7)) & 1u;
+  }
+}
+
+void packBits(const jboolean *src, uint8_t *bits, size_t size) {
+  size_t bytes = (size + 7) / 8;
+  std::memset(bits, 0, bytes);
+  for (size_t i = 0; i < size; ++i) {
+    if (src[i]) {
+      bits[i >> 3] |= static_cast<uint8_t>(1u << (i & 7));
+    }
+  }
+}
+}
+
+#pragma mark - vectorized kernels
+
+void doubleToFloat(const jdouble *src, jfloat *dst, size_t size) {
+  size_t i = 0;
+#if defined(JNICPP11_NEON) && defined(__aarch64__)
+  for (; i + 4 <= size; i += 4) {
+    float32x2_t lo = vcvt_f32_f64(vld1q_f64(src + i));
+    float32x2_t hi = vcvt_f32_f64(vld1q_f64(src + i + 2));
+    vst1q_f32(dst + i, vcombine_f32(lo, hi));
+  }
+#elif defined(JNICPP11_SSE2)
+  for (; i + 4 <= size; i += 4) {
+    __m128 lo = _mm_cvtpd_ps(_mm_loadu_pd(src + i));
+    __m128 hi = _mm_cvtpd_ps(_mm_loadu_pd(src + i + 2));
+    _mm_storeu_ps(dst + i, _mm_movelh_ps(lo, hi));
+  }
+#endif
+  scalar::doubleToFloat(src + i, dst + i, size - i);
+}
+
+void floatToDouble(const jfloat *src, jdouble *dst, size_t size) {
+  size_t i = 0;
+#if defined(JNICPP11_NEON) && defined(__aarch64__)
+  for (; i + 4 <= size; i += 4) {
+    float32x4_t v = vld1q_f32(src + i);
+    vst1q_f64(dst + i, vcvt_f64_f32(vget_low_f32(v)));
+    vst1q_f64(dst + i + 2, vcvt_high_f64_f32(v));
+  }
+#elif defined(JNICPP11_SSE2)
+  for (; i + 4 <= size; i += 4) {
+    __m128 v = _mm_loadu_ps(src + i);
+    _mm_storeu_pd(dst + i, _mm_cvtps_pd(v));
+    _mm_storeu_pd(dst + i + 2, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+  }
+#endif
+  scalar::floatToDouble(src + i, dst + i, size - i);
+}
+
+void halfToFloat(const Half *src, jfloat *dst, size_t size) {
+  size_t i = 0;
+#if defined(JNICPP11_NEON) && defined(__aarch64__)
+  for (; i + 4 <= size; i += 4) {
+    float16x4_t h = vreinterpret_f16_u16(vld1_u16(reinterpret_cast<const uint16_t *>(src + i)));
+    vst1q_f32(dst + i, vcvt_f32_f16(h));
+  }
+#elif defined(JNICPP11_SSE2) && defined(__F16C__)
+  for (; i + 8 <= size; i += 8) {
+    __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+  }
+#endif
+  scalar::halfToFloat(src + i, dst + i, size - i);
+}
+
+void floatToHalf(const jfloat *src, Half *dst, size_t size) {
+  size_t i = 0;
+#if defined(JNICPP11_NEON) && defined(__aarch64__)
+  for (; i + 4 <= size; i += 4) {
+    float16x4_t h = vcvt_f16_f32(vld1q_f32(src + i));
+    vst1_u16(reinterpret_cast<uint16_t *>(dst + i), vreinterpret_u16_f16(h));
+  }
+#elif defined(JNICPP11_SSE2) && defined(__F16C__)
+  for (; i + 8 <= size; i += 8) {
+    __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), h);
+  }
+#endif
+  scalar::floatToHalf(src + i, dst + i, size - i);
+}
+
+void int64ToInt32(const int64_t *src, jint *dst, size_t size) {
+  size_t i = 0;
+#if defined(JNICPP11_NEON)
+  for (; i + 4 <= size; i += 4) {
+    int32x2_t lo = vmovn_s64(vld1q_s64(src + i));
+    int32x2_t hi = vmovn_s64(vld1q_s64(src + i + 2));
+    vst1q_s32(dst + i, vcombine_s32(lo, hi));
+  }
+#elif defined(JNICPP11_SSE2)
+  for (; i + 4 <= size; i += 4) {
+    __m128i lo = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)), _MM_SHUFFLE(3, 1, 2, 0));
+    __m128i hi = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 2)), _MM_SHUFFLE(3, 1, 2, 0));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_unpacklo_epi64(lo, hi));
+  }
+#endif
+  scalar::int64ToInt32(src + i, dst + i, size - i);
+}
+
+void int32ToInt64(const jint *src, int64_t *dst, size_t size) {
+  size_t i = 0;
+#if defined(JNICPP11_NEON)
+  for (; i + 4 <= size; i += 4) {
+    int32x4_t v = vld1q_s32(src + i);
+    vst1q_s64(dst + i, vmovl_s32(vget_low_s32(v)));
+    vst1q_s64(dst + i + 2, vmovl_s32(vget_high_s32(v)));
+  }
+#elif defined(JNICPP11_SSE2)
+  for (; i + 4 <= size; i += 4) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    __m128i sign = _mm_srai_epi32(v, 31);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_unpacklo_epi32(v, sign));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 2), _mm_unpackhi_epi32(v, sign));
+  }
+#endif
+  scalar::int32ToInt64(src + i, dst + i, size - i);
+}
+
+void unpackBits(const uint8_t *bits, jboolean *dst, size_t size) {
+  size_t i = 0;
+#if defined(JNICPP11_NEON)
+  static const uint8_t kMask[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+  const uint8x16_t mask = vld1q_u8(kMask);
+  const uint8x16_t one = vdupq_n_u8(1);
+  for (; i + 16 <= size; i += 16) {
+    uint8x16_t v = vcombine_u8(vdup_n_u8(bits[i >> 3]), vdup_n_u8(bits[(i >> 3) + 1]));
+    vst1q_u8(dst + i, vandq_u8(vtstq_u8(v, mask), one));
+  }
+#elif defined(JNICPP11_SSE2)
+  const __m128i mask = _mm_set_epi8(-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1);
+  const __m128i one = _mm_set1_epi8(1);
+  for (; i + 16 <= size; i += 16) {
+    __m128i v = _mm_cvtsi32_si128(bits[i >> 3] | (bits[(i >> 3) + 1] << 8));
+    v = _mm_unpacklo_epi8(v, v);
+    v = _mm_unpacklo_epi16(v, v);
+    v = _mm_unpacklo_epi32(v, v);
+    __m128i set = _mm_cmpeq_epi8(_mm_and_si128(v, mask), mask);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_and_si128(set, one));
+  }
+#endif
+  scalar::unpackBits(bits + (i >> 3), dst + i, size - i);
+}
+
+void packBits(const jboolean *src, uint8_t *bits, size_t size) {
+  size_t i = 0;
+#if defined(JNICPP11_NEON)
+  static const uint8_t kMask[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+  const uint8x16_t mask = vld1q_u8(kMask);
+  for (; i + 16 <= size; i += 16) {
+    uint8x16_t v = vld1q_u8(src + i);
+    uint8x16_t weighted = vandq_u8(vtstq_u8(v, v), mask);
+    uint8x8_t sum = vpadd_u8(vget_low_u8(weighted), vget_high_u8(weighted));
+    sum = vpadd_u8(sum, sum);
+    sum = vpadd_u8(sum, sum);
+    bits[i >> 3] = vget_lane_u8(sum, 0);
+    bits[(i >> 3) + 1] = vget_lane_u8(sum, 1);
+  }
+#elif defined(JNICPP11_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16 <= size; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    int set = ~_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)) & 0xffff;
+    bits[i >> 3] = static_cast<uint8_t>(set);
+    bits[(i >> 3) + 1] = static_cast<uint8_t>(set >> 8);
+  }
+#endif
+  scalar::packBits(src + i, bits + (i >> 3), size - i);
+}
+}
+}  // namespace jnicpp11
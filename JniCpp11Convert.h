@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include <jni.h>
+
+namespace jnicpp11 {
+
+/**
+ *  IEEE 754 binary16 value, stored as raw bits. Used as an element type for half-float buffers.
+ */
+struct Half {
+  uint16_t bits;
+};
+
+namespace convert {
+
+#pragma mark - conversion kernels
+// Each kernel uses NEON or SSE2 (F16C for half floats) when available and falls back to the scalar version otherwise.
+
+void doubleToFloat(const jdouble *src, jfloat *dst, size_t size);
+void floatToDouble(const jfloat *src, jdouble *dst, size_t size);
+void halfToFloat(const Half *src, jfloat *dst, size_t size);
+void floatToHalf(const jfloat *src, Half *dst, size_t size);
+void int64ToInt32(const int64_t *src, jint *dst, size_t size);
+void int32ToInt64(const jint *src, int64_t *dst, size_t size);
+// Bits are LSB-first: element i lives in bit (i % 8) of byte (i / 8).
+void unpackBits(const uint8_t *bits, jboolean *dst, size_t size);
+void packBits(const jboolean *src, uint8_t *bits, size_t size);
+
+namespace scalar {
+void doubleToFloat(const jdouble *src, jfloat *dst, size_t size);
+void floatToDouble(const jfloat *src, jdouble *dst, size_t size);
+void halfToFloat(const Half *src, jfloat *dst, size_t size);
+void floatToHalf(const jfloat *src, Half *dst, size_t size);
+void int64ToInt32(const int64_t *src, jint *dst, size_t size);
+void int32ToInt64(const jint *src, int64_t *dst, size_t size);
+void unpackBits(const uint8_t *bits, jboolean *dst, size_t size);
+void packBits(const jboolean *src, uint8_t *bits, size_t size);
+}
+
+#pragma mark - Converter
+
+template <typename From, typename To>
+struct isSameRepresentation
+    : std::integral_constant<bool,
+                             std::is_same<From, To>::value || (std::is_integral<From>::value && std::is_integral<To>::value &&
+                                                               sizeof(From) == sizeof(To) && !std::is_same<From, bool>::value &&
+                                                               !std::is_same<To, bool>::value)> {};
+
+/**
+ *  Converter<From, To>::run converts size elements from src into dst.
+ *  isIdentity is true when the element representations match and a plain copy suffices.
+ */
+template <typename From, typename To, typename Enable = void> struct Converter {
+  static_assert(std::is_arithmetic<From>::value && std::is_arithmetic<To>::value, "Unsupported array element conversion.");
+  static constexpr bool isIdentity = false;
+  static void run(const From *src, To *dst, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+      dst[i] = static_cast<To>(src[i]);
+    }
+  }
+};
+
+template <typename From, typename To>
+struct Converter<From, To, typename std::enable_if<isSameRepresentation<From, To>::value>::type> {
+  static constexpr bool isIdentity = true;
+  static void run(const From *src, To *dst, size_t size) { std::memcpy(dst, src, size * sizeof(To)); }
+};
+
+template <> struct Converter<bool, jboolean> {
+  static constexpr bool isIdentity = false;
+  static void run(const bool *src, jboolean *dst, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+      dst[i] = src[i] ? JNI_TRUE : JNI_FALSE;
+    }
+  }
+};
+
+template <> struct Converter<jboolean, bool> {
+  static constexpr bool isIdentity = false;
+  static void run(const jboolean *src, bool *dst, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+      dst[i] = src[i] != JNI_FALSE;
+    }
+  }
+};
+
+#define KERNEL_CONVERTER(FROM, TO, KERNEL)                                             \
+  template <> struct Converter<FROM, TO> {                                             \
+    static constexpr bool isIdentity = false;                                          \
+    static void run(const FROM *src, TO *dst, size_t size) { KERNEL(src, dst, size); } \
+  };
+
+KERNEL_CONVERTER(jdouble, jfloat, doubleToFloat)
+KERNEL_CONVERTER(jfloat, jdouble, floatToDouble)
+KERNEL_CONVERTER(Half, jfloat, halfToFloat)
+KERNEL_CONVERTER(jfloat, Half, floatToHalf)
+KERNEL_CONVERTER(int64_t, jint, int64ToInt32)
+KERNEL_CONVERTER(jint, int64_t, int32ToInt64)
+
+#undef KERNEL_CONVERTER
+}
+}  // namespace jnicpp11
@@ -0,0 +1,80 @@
+#pragma once
+
+/**
+ *  Optional C++20 coroutine support on top of JavaAsync. Header only; compiles to nothing before C++20.
+ *
+ *  Task loadProfile(JavaObject api) {
+ *    JavaObject profile = co_await awaitCompletion(api.call<JavaObject>("fetchProfile", JavaObject(nullptr)));
+ *    ...
+ *  }
+ *
+ *  The coroutine resumes on the Java thread that completed the stage, or immediately if it had already completed.
+ *  A failed stage makes co_await throw JniException.
+ */
+
+#if __cplusplus >= 202002L && defined(__has_include)
+#if __has_include(<coroutine>)
+
+#include <atomic>
+#include <coroutine>
+#include <memory>
+
+#include "JniCpp11Async.h"
+
+namespace jnicpp11 {
+
+class JavaAwaitable {
+ public:
+  explicit JavaAwaitable(const JavaObject &completionStage)
+      : _completionStage(completionStage), _state(std::make_shared<State>()) {}
+
+  bool await_ready() const noexcept { return false; }
+
+  bool await_suspend(std::coroutine_handle<> handle) {
+    std::shared_ptr<State> state = _state;
+    state->handle = handle;
+    bool registered = JavaAsync::then(_completionStage, [state](const JavaCompletion &completion) {
+      state->failed = completion.failed;
+      if (completion.failed) {
+        state->error = JavaAsync::describeError(completion);
+      } else {
+        state->result = completion.result.toGlobalRef();
+      }
+      // whoever comes second resumes: the callback if await_suspend already returned, await_suspend otherwise
+      if (state->completed.exchange(true, std::memory_order_acq_rel)) {
+        state->handle.resume();
+      }
+    });
+    if (!registered) {
+      state->failed = true;
+      state->error = "Failed to observe CompletionStage.";
+      return false;
+    }
+    return !state->completed.exchange(true, std::memory_order_acq_rel);
+  }
+
+  JavaObject await_resume() {
+    if (_state->failed) {
+      throw JniException(_state->error);
+    }
+    return _state->result;
+  }
+
+ private:
+  struct State {
+    std::coroutine_handle<> handle;
+    std::atomic<bool> completed{false};
+    bool failed = false;
+    JavaObject result{nullptr};
+    std::string error;
+  };
+
+  JavaObject _completionStage;
+  std::shared_ptr<State> _state;
+};
+
+inline JavaAwaitable awaitCompletion(const JavaObject &completionStage) { return JavaAwaitable(completionStage); }
+}  // namespace jnicpp11
+
+#endif
+#endif
@@ -0,0 +1,225 @@
+#include "JniCpp11Iteration.h"
+
+namespace jnicpp11 {
+
+#pragma mark - cached method IDs
+
+namespace {
+struct CollectionMethods {
+  jmethodID iterableIterator = nullptr;
+  jmethodID iteratorHasNext = nullptr;
+  jmethodID iteratorNext = nullptr;
+  jmethodID listSize = nullptr;
+  jmethodID listGet = nullptr;
+  jmethodID mapEntrySet = nullptr;
+  jmethodID entryGetKey = nullptr;
+  jmethodID entryGetValue = nullptr;
+  bool resolved = false;
+};
+
+jmethodID getMethodId(JNIEnv *env, const char *classPath, const char *name, const char *signature) JNICPP11_THROWS(JniException) {
+  jclass clazz = env_util::findClass(env, classPath);
+  jmethodID methodId = nullptr;
+  try {
+    methodId = env_util::getMethodId(env, clazz, name, signature, false);
+  } catch (...) {
+    env->DeleteLocalRef(clazz);
+    throw;
+  }
+  env->DeleteLocalRef(clazz);
+  return methodId;
+}
+
+CollectionMethods resolveCollectionMethods(JNIEnv *env) {
+  CollectionMethods methods;
+  try {
+    methods.iterableIterator = getMethodId(env, "java/lang/Iterable", "iterator", "()Ljava/util/Iterator;");
+    methods.iteratorHasNext = getMethodId(env, "java/util/Iterator", "hasNext", "()Z");
+    methods.iteratorNext = getMethodId(env, "java/util/Iterator", "next", "()Ljava/lang/Object;");
+    methods.listSize = getMethodId(env, "java/util/List", "size", "()I");
+    methods.listGet = getMethodId(env, "java/util/List", "get", "(I)Ljava/lang/Object;");
+    methods.mapEntrySet = getMethodId(env, "java/util/Map", "entrySet", "()Ljava/util/Set;");
+    methods.entryGetKey = getMethodId(env, "java/util/Map$Entry", "getKey", "()Ljava/lang/Object;");
+    methods.entryGetValue = getMethodId(env, "java/util/Map$Entry", "getValue", "()Ljava/lang/Object;");
+    methods.resolved = true;
+  } catch (const JniException &e) {
+    e.log();
+  }
+  return methods;
+}
+
+// java.util classes are loaded by the boot class loader and never unloaded, so their method IDs stay valid.
+const CollectionMethods &getCollectionMethods(JNIEnv *env) JNICPP11_THROWS(JniException) {
+  static const CollectionMethods methods = resolveCollectionMethods(env);
+  if (!methods.resolved) {
+    throw JniException("Failed to resolve java.util collection methods.");
+  }
+  return methods;
+}
+
+JavaObject makeElement(jobject obj, const std::shared_ptr<JavaClass> &elementClass) {
+  return elementClass ? JavaObject::borrow(obj, *elementClass) : JavaObject::borrow(obj);
+}
+
+std::shared_ptr<JavaClass> shareClass(const JavaClass &clazz) { return std::make_shared<JavaClass>(clazz); }
+}
+
+#pragma mark - JavaIterableSource
+
+JavaIterableSource::JavaIterableSource(const JavaObject &iterable, std::shared_ptr<JavaClass> elementClass)
+    : _iterable(iterable), _iterator(nullptr), _elementClass(elementClass) {}
+
+bool JavaIterableSource::open(JNIEnv *env) JNICPP11_THROWS(JniException) {
+  if (!_iterable) {
+    return false;
+  }
+  const CollectionMethods &methods = getCollectionMethods(env);
+  _iterator = JavaObject(env->CallObjectMethod(_iterable.getJObject(), methods.iterableIterator));
+  JniException::checkException(env);
+  return _iterator;
+}
+
+void JavaIterableSource::fetch(JNIEnv *env, std::vector<value_type> &out, jsize max) JNICPP11_THROWS(JniException) {
+  const CollectionMethods &methods = getCollectionMethods(env);
+  jobject iterator = _iterator.getJObject();
+  for (jsize i = 0; i < max; ++i) {
+    jboolean hasNext = env->CallBooleanMethod(iterator, methods.iteratorHasNext);
+    JniException::checkException(env);
+    if (!hasNext) {
+      break;
+    }
+    jobject element = env->CallObjectMethod(iterator, methods.iteratorNext);
+    JniException::checkException(env);
+    out.push_back(makeElement(element, _elementClass));
+  }
+}
+
+#pragma mark - JavaListSource
+
+JavaListSource::JavaListSource(const JavaObject &list, std::shared_ptr<JavaClass> elementClass)
+    : _list(list), _elementClass(elementClass) {}
+
+bool JavaListSource::open(JNIEnv *env) JNICPP11_THROWS(JniException) {
+  if (!_list) {
+    return false;
+  }
+  const CollectionMethods &methods = getCollectionMethods(env);
+  _size = env->CallIntMethod(_list.getJObject(), methods.listSize);
+  JniException::checkException(env);
+  _position = 0;
+  return _size > 0;
+}
+
+void JavaListSource::fetch(JNIEnv *env, std::vector<value_type> &out, jsize max) JNICPP11_THROWS(JniException) {
+  const CollectionMethods &methods = getCollectionMethods(env);
+  jobject list = _list.getJObject();
+  for (jsize i = 0; i < max && _position < _size; ++i, ++_position) {
+    jobject element = env->CallObjectMethod(list, methods.listGet, _position);
+    JniException::checkException(env);
+    out.push_back(makeElement(element, _elementClass));
+  }
+}
+
+#pragma mark - JavaMapSource
+
+JavaMapSource::JavaMapSource(const JavaObject &map) : _map(map), _iterator(nullptr) {}
+
+bool JavaMapSource::open(JNIEnv *env) JNICPP11_THROWS(JniException) {
+  if (!_map) {
+    return false;
+  }
+  const CollectionMethods &methods = getCollectionMethods(env);
+  jobject entrySet = env->CallObjectMethod(_map.getJObject(), methods.mapEntrySet);
+  JniException::checkException(env);
+  _iterator = JavaObject(env->CallObjectMethod(entrySet, methods.iterableIterator));
+  env->DeleteLocalRef(entrySet);
+  JniException::checkException(env);
+  return _iterator;
+}
+
+void JavaMapSource::fetch(JNIEnv *env, std::vector<value_type> &out, jsize max) JNICPP11_THROWS(JniException) {
+  const CollectionMethods &methods = getCollectionMethods(env);
+  jobject iterator = _iterator.getJObject();
+  for (jsize i = 0; i < max; ++i) {
+    jboolean hasNext = env->CallBooleanMethod(iterator, methods.iteratorHasNext);
+    JniException::checkException(env);
+    if (!hasNext) {
+      break;
+    }
+    jobject entry = env->CallObjectMethod(iterator, methods.iteratorNext);
+    JniException::checkException(env);
+    // only exception and reference functions may be called while an exception is pending
+    jobject key = env->CallObjectMethod(entry, methods.entryGetKey);
+    if (env->ExceptionCheck()) {
+      env->DeleteLocalRef(key);
+      env->DeleteLocalRef(entry);
+      JniException::checkException(env);
+    }
+    jobject value = env->CallObjectMethod(entry, methods.entryGetValue);
+    env->DeleteLocalRef(entry);
+    if (env->ExceptionCheck()) {
+      env->DeleteLocalRef(value);
+      env->DeleteLocalRef(key);
+      JniException::checkException(env);
+    }
+    out.push_back({JavaObject::borrow(key), JavaObject::borrow(value)});
+  }
+}
+
+#pragma mark - JavaArraySource
+
+JavaArraySource::JavaArraySource(const JavaObject &array, std::shared_ptr<JavaClass> elementClass)
+    : _array(array), _elementClass(elementClass) {}
+
+bool JavaArraySource::open(JNIEnv *env) JNICPP11_THROWS(JniException) {
+  if (!_array) {
+    return false;
+  }
+  _length = env->GetArrayLength((jarray)_array.getJObject());
+  _position = 0;
+  return _length > 0;
+}
+
+void JavaArraySource::fetch(JNIEnv *env, std::vector<value_type> &out, jsize max) JNICPP11_THROWS(JniException) {
+  jobjectArray array = (jobjectArray)_array.getJObject();
+  for (jsize i = 0; i < max && _position < _length; ++i, ++_position) {
+    jobject element = env->GetObjectArrayElement(array, _position);
+    JniException::checkException(env);
+    out.push_back(makeElement(element, _elementClass));
+  }
+}
+
+#pragma mark - range factories
+
+JavaChunkedRange<JavaIterableSource> iterate(const JavaObject &iterable, jsize chunkSize) {
+  return JavaChunkedRange<JavaIterableSource>(JavaIterableSource(iterable, nullptr), chunkSize);
+}
+
+JavaChunkedRange<JavaIterableSource> iterate(const JavaObject &iterable, const JavaClass &elementClass, jsize chunkSize) {
+  return JavaChunkedRange<JavaIterableSource>(JavaIterableSource(iterable, shareClass(elementClass)), chunkSize);
+}
+
+JavaChunkedRange<JavaListSource> iterateList(const JavaObject &list, jsize chunkSize) {
+  return JavaChunkedRange<JavaListSource>(JavaListSource(list, nullptr), chunkSize);
+}
+
+JavaChunkedRange<JavaListSource> iterateList(const JavaObject &list, const JavaClass &elementClass, jsize chunkSize) {
+  return JavaChunkedRange<JavaListSource>(JavaListSource(list, shareClass(elementClass)), chunkSize);
+}
+
+JavaChunkedRange<JavaMapSource> iterateMap(const JavaObject &map, jsize chunkSize) {
+  return JavaChunkedRange<JavaMapSource>(JavaMapSource(map), chunkSize);
+}
+
+JavaChunkedRange<JavaArraySource> iterateArray(const JavaObject &array, jsize chunkSize) {
+  return JavaChunkedRange<JavaArraySource>(JavaArraySource(array, nullptr), chunkSize);
+}
+
+JavaChunkedRange<JavaArraySource> iterateArray(const JavaObject &array, const JavaClass &elementClass, jsize chunkSize) {
+  return JavaChunkedRange<JavaArraySource>(JavaArraySource(array, shareClass(elementClass)), chunkSize);
+}
+
+JavaChunkedRange<JavaArraySource> iterateArray(const JavaArray<JavaObject> &array, jsize chunkSize) {
+  return JavaChunkedRange<JavaArraySource>(JavaArraySource(array, shareClass(array.getElementClass())), chunkSize);
+}
+}  // namespace jnicpp11
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "JniCpp11.h"
+
+namespace jnicpp11 {
+
+/**
+ *  Lazy, chunked iteration over Java collections.
+ *
+ *  for (const JavaObject &file : iterateList(files)) {
+ *    if (file.call<std::string>("getName", "") == wanted) {
+ *      break;
+ *    }
+ *  }
+ *
+ *  Elements are fetched chunkSize at a time with cached method IDs, and every chunk runs inside its own local
+ *  frame. At most one chunk of references is alive at a time, however large the collection is. Elements (and any
+ *  local reference created in the loop body) are released when the iterator moves to the next chunk, so use
+ *  JavaObject::toGlobalRef to keep one. Iterate on a single thread.
+ *
+ *  Passing the element class avoids a GetObjectClass call per element when calling methods on the elements.
+ */
+
+struct JavaMapEntry {
+  JavaObject key;
+  JavaObject value;
+};
+
+#pragma mark - Sources
+// A source prepares its cursor in open (outside of any chunk frame) and appends at most max elements per fetch.
+
+class JavaIterableSource {
+ public:
+  typedef JavaObject value_type;
+  static constexpr jint refsPerElement = 1;
+
+  JavaIterableSource(const JavaObject &iterable, std::shared_ptr<JavaClass> elementClass);
+  bool open(JNIEnv *env) JNICPP11_THROWS(JniException);
+  void fetch(JNIEnv *env, std::vector<value_type> &out, jsize max) JNICPP11_THROWS(JniException);
+
+ private:
+  JavaObject _iterable;
+  JavaObject _iterator;
+  std::shared_ptr<JavaClass> _elementClass;
+};
+
+class JavaListSource {
+ public:
+  typedef JavaObject value_type;
+  static constexpr jint refsPerElement = 1;
+
+  JavaListSource(const JavaObject &list, std::shared_ptr<JavaClass> elementClass);
+  bool open(JNIEnv *env) JNICPP11_THROWS(JniException);
+  void fetch(JNIEnv *env, std::vector<value_type> &out, jsize max) JNICPP11_THROWS(JniException);
+
+ private:
+  JavaObject _list;
+  std::shared_ptr<JavaClass> _elementClass;
+  jint _size = 0;
+  jint _position = 0;
+};
+
+class JavaMapSource {
+ public:
+  typedef JavaMapEntry value_type;
+  static constexpr jint refsPerElement = 2;
+
+  JavaMapSource(const JavaObject &map);
+  bool open(JNIEnv *env) JNICPP11_THROWS(JniException);
+  void fetch(JNIEnv *env, std::vector<value_type> &out, jsize max) JNICPP11_THROWS(JniException);
+
+ private:
+  JavaObject _map;
+  JavaObject _iterator;
+};
+
+class JavaArraySource {
+ public:
+  typedef JavaObject value_type;
+  static constexpr jint refsPerElement = 1;
+
+  JavaArraySource(const JavaObject &array, std::shared_ptr<JavaClass> elementClass);
+  bool open(JNIEnv *env) JNICPP11_THROWS(JniException);
+  void fetch(JNIEnv *env, std::vector<value_type> &out, jsize max) JNICPP11_THROWS(JniException);
+
+ private:
+  JavaObject _array;
+  std::shared_ptr<JavaClass> _elementClass;
+  jsize _length = 0;
+  jsize _position = 0;
+};
+
+#pragma mark - JavaChunkedRange
+
+template <typename Source> class JavaChunkedRange {
+ public:
+  typedef typename Source::value_type value_type;
+
+  class iterator {
+   public:
+    iterator() = default;
+    iterator(iterator &&other) = default;
+    iterator &operator=(iterator &&other) {
+      finish();
+      _state = std::move(other._state);
+      return *this;
+    }
+    ~iterator();
+
+    const value_type &operator*() const { return _state->chunk[_state->index]; }
+    const value_type *operator->() const { return &_state->chunk[_state->index]; }
+    iterator &operator++();
+    bool operator==(const iterator &other) const { return atEnd() == other.atEnd(); }
+    bool operator!=(const iterator &other) const { return !(*this == other); }
+
+   private:
+    friend class JavaChunkedRange;
+
+    struct State {
+      State(const Source &source, jsize chunkSize) : source(source), chunkSize(chunkSize) {}
+      Source source;
+      jsize chunkSize;
+      JNIEnv *env = nullptr;
+      std::vector<value_type> chunk;
+      size_t index = 0;
+      bool framePushed = false;
+    };
+
+    iterator(const Source &source, jsize chunkSize);
+    bool atEnd() const { return _state == nullptr; }
+    void nextChunk();
+    void finish();
+
+    std::unique_ptr<State> _state;
+  };
+
+  JavaChunkedRange(const Source &source, jsize chunkSize) : _source(source), _chunkSize(chunkSize > 0 ? chunkSize : 1) {}
+
+  iterator begin() const { return iterator(_source, _chunkSize); }
+  iterator end() const { return iterator(); }
+
+ private:
+  Source _source;
+  jsize _chunkSize;
+};
+
+JavaChunkedRange<JavaIterableSource> iterate(const JavaObject &iterable, jsize chunkSize = 64);
+JavaChunkedRange<JavaIterableSource> iterate(const JavaObject &iterable, const JavaClass &elementClass, jsize chunkSize = 64);
+JavaChunkedRange<JavaListSource> iterateList(const JavaObject &list, jsize chunkSize = 64);
+JavaChunkedRange<JavaListSource> iterateList(const JavaObject &list, const JavaClass &elementClass, jsize chunkSize = 64);
+JavaChunkedRange<JavaMapSource> iterateMap(const JavaObject &map, jsize chunkSize = 64);
+JavaChunkedRange<JavaArraySource> iterateArray(const JavaObject &array, jsize chunkSize = 64);
+JavaChunkedRange<JavaArraySource> iterateArray(const JavaObject &array, const JavaClass &elementClass, jsize chunkSize = 64);
+// Elements are typed with the array's element class.
+JavaChunkedRange<JavaArraySource> iterateArray(const JavaArray<JavaObject> &array, jsize chunkSize = 64);
+
+#pragma mark - JavaChunkedRange template methods
+
+template <typename Source> JavaChunkedRange<Source>::iterator::iterator(const Source &source, jsize chunkSize) {
+  _state.reset(new State(source, chunkSize));
+  try {
+    _state->env = Jni::getEnv();
+    if (_state->env == nullptr) {
+      throw JniException("Failed to get JNIEnv.");
+    }
+    if (!_state->source.open(_state->env)) {
+      _state.reset();
+      return;
+    }
+    _state->chunk.reserve(chunkSize);
+  } catch (const JniException &e) {
+    e.log();
+    _state.reset();
+    return;
+  }
+  nextChunk();
+}
+
+template <typename Source> JavaChunkedRange<Source>::iterator::~iterator() { finish(); }
+
+template <typename Source> typename JavaChunkedRange<Source>::iterator &JavaChunkedRange<Source>::iterator::operator++() {
+  if (++_state->index >= _state->chunk.size()) {
+    nextChunk();
+  }
+  return *this;
+}
+
+template <typename Source> void JavaChunkedRange<Source>::iterator::nextChunk() {
+  JNIEnv *env = _state->env;
+  _state->chunk.clear();
+  _state->index = 0;
+  try {
+    if (_state->framePushed) {
+      _state->framePushed = false;
+      env->PopLocalFrame(nullptr);
+    }
+    if (env->PushLocalFrame(_state->chunkSize * Source::refsPerElement + 2) != JNI_OK) {
+      throw JniException("PushLocalFrame failed.");
+    }
+    _state->framePushed = true;
+    _state->source.fetch(env, _state->chunk, _state->chunkSize);
+  } catch (const JniException &e) {
+    e.log();
+    _state->chunk.clear();
+  }
+  if (_state->chunk.empty()) {
+    finish();
+  }
+}
+
+template <typename Source> void JavaChunkedRange<Source>::iterator::finish() {
+  if (_state == nullptr) {
+    return;
+  }
+  _state->chunk.clear();
+  if (_state->framePushed) {
+    _state->env->PopLocalFrame(nullptr);
+  }
+  _state.reset();
+}
+}  // namespace jnicpp11
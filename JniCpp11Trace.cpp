@@ -0,0 +1,243 @@
+#include "JniCpp11Trace.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+namespace jnicpp11 {
+
+#pragma mark - buffers
+
+namespace {
+struct TraceEvent {
+  // odd while the owning thread writes the slot
+  std::atomic<uint32_t> sequence{0};
+  char phase = 'X';
+  const char *kind = nullptr;
+  char name[64];
+  // per event, since a buffer is reused by other threads after its thread exits
+  uint64_t tid = 0;
+  uint64_t startNs = 0;
+  uint64_t durationNs = 0;
+};
+
+struct ThreadBuffer {
+  explicit ThreadBuffer(size_t capacity) : capacity(capacity), events(new TraceEvent[capacity]) {}
+
+  ThreadBuffer *next = nullptr;
+  const size_t capacity;
+  std::unique_ptr<TraceEvent[]> events;
+  // total number of events written; only the owning thread advances it
+  std::atomic<uint64_t> head{0};
+  // false once the owning thread exited; the next thread to claim it overwrites the oldest spans first
+  std::atomic<bool> owned{true};
+};
+
+// Buffers are pushed onto a lock-free list and never freed, so spans of exited threads can still be exported.
+// Buffers of exited threads are reused, so the list only grows with the number of threads recording at once.
+std::atomic<ThreadBuffer *> g_buffers{nullptr};
+std::atomic<size_t> g_capacity{8192};
+std::atomic<uint64_t> g_sessionStartNs{0};
+thread_local ThreadBuffer *t_buffer = nullptr;
+thread_local uint64_t t_tid = 0;
+thread_local bool t_exited = false;
+
+// Releases the thread's buffer at thread exit. Kept apart from t_buffer so that recording does not pay for the
+// initialization check of a thread_local with a destructor.
+struct BufferRelease {
+  ~BufferRelease() {
+    if (t_buffer) {
+      t_buffer->owned.store(false, std::memory_order_release);
+      t_buffer = nullptr;
+    }
+    t_exited = true;
+  }
+};
+thread_local BufferRelease t_release;
+
+uint64_t currentThreadId() {
+#if defined(__linux__)
+  return (uint64_t)syscall(SYS_gettid);
+#else
+  static std::atomic<uint64_t> nextId{1};
+  return nextId.fetch_add(1, std::memory_order_relaxed);
+#endif
+}
+
+ThreadBuffer *claimFreeBuffer(size_t capacity) {
+  for (ThreadBuffer *buffer = g_buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+    bool owned = false;
+    if (buffer->capacity == capacity && !buffer->owned.load(std::memory_order_relaxed) &&
+        buffer->owned.compare_exchange_strong(owned, true, std::memory_order_acquire, std::memory_order_relaxed)) {
+      return buffer;
+    }
+  }
+  return nullptr;
+}
+
+// Returns nullptr while the thread's thread_local destructors run, as the buffer could not be released anymore.
+ThreadBuffer *threadBuffer() {
+  if (t_buffer == nullptr) {
+    if (t_exited) {
+      return nullptr;
+    }
+    (void)&t_release;  // registers the destructor
+    size_t capacity = g_capacity.load(std::memory_order_relaxed);
+    ThreadBuffer *buffer = claimFreeBuffer(capacity);
+    if (buffer == nullptr) {
+      buffer = new ThreadBuffer(capacity);
+      buffer->next = g_buffers.load(std::memory_order_relaxed);
+      while (!g_buffers.compare_exchange_weak(buffer->next, buffer, std::memory_order_release, std::memory_order_relaxed)) {
+      }
+    }
+    t_tid = currentThreadId();
+    t_buffer = buffer;
+  }
+  return t_buffer;
+}
+
+void writeEvent(char phase, const char *kind, const char *name, size_t nameLength, uint64_t startNs, uint64_t durationNs) {
+  ThreadBuffer *buffer = threadBuffer();
+  if (buffer == nullptr) {
+    return;
+  }
+  uint64_t head = buffer->head.load(std::memory_order_relaxed);
+  TraceEvent &event = buffer->events[head % buffer->capacity];
+  uint32_t sequence = event.sequence.load(std::memory_order_relaxed);
+  event.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  event.phase = phase;
+  event.kind = kind;
+  nameLength = nameLength < sizeof(event.name) - 1 ? nameLength : sizeof(event.name) - 1;
+  memcpy(event.name, name, nameLength);
+  event.name[nameLength] = '\0';
+  event.tid = t_tid;
+  event.startNs = startNs;
+  event.durationNs = durationNs;
+  event.sequence.store(sequence + 2, std::memory_order_release);
+  buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void appendJsonString(std::ostringstream &os, const char *str) {
+  os << '"';
+  for (const char *c = str; *c; ++c) {
+    switch (*c) {
+      case '"':
+        os << "\\\"";
+        break;
+      case '\\':
+        os << "\\\\";
+        break;
+      default:
+        if ((unsigned char)*c < 0x20) {
+          char escaped[8];
+          snprintf(escaped, sizeof(escaped), "\\u%04x", *c);
+          os << escaped;
+        } else {
+          os << *c;
+        }
+    }
+  }
+  os << '"';
+}
+}
+
+#pragma mark - JniTrace
+
+std::atomic<bool> JniTrace::_enabled{false};
+
+void JniTrace::start() {
+  g_sessionStartNs.store(now(), std::memory_order_relaxed);
+  _enabled.store(true, std::memory_order_release);
+}
+
+void JniTrace::stop() { _enabled.store(false, std::memory_order_release); }
+
+void JniTrace::setBufferCapacity(size_t spansPerThread) {
+  g_capacity.store(spansPerThread > 0 ? spansPerThread : 1, std::memory_order_relaxed);
+}
+
+uint64_t JniTrace::now() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void JniTrace::record(const char *kind, const std::string *detail, uint64_t startNs) {
+  uint64_t endNs = now();
+  if (detail) {
+    writeEvent('X', kind, detail->c_str(), detail->size(), startNs, endNs - startNs);
+  } else {
+    writeEvent('X', kind, kind, strlen(kind), startNs, endNs - startNs);
+  }
+}
+
+void JniTrace::instant(const char *name) {
+  if (isEnabled()) {
+    writeEvent('i', "marker", name, strlen(name), now(), 0);
+  }
+}
+
+std::string JniTrace::toChromeTrace() {
+  uint64_t sessionStartNs = g_sessionStartNs.load(std::memory_order_relaxed);
+  std::ostringstream os;
+  os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  bool first = true;
+  long pid = (long)getpid();
+  TraceEvent copy;
+  for (ThreadBuffer *buffer = g_buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+    uint64_t head = buffer->head.load(std::memory_order_acquire);
+    uint64_t begin = head > buffer->capacity ? head - buffer->capacity : 0;
+    for (uint64_t i = begin; i < head; ++i) {
+      const TraceEvent &event = buffer->events[i % buffer->capacity];
+      // copy the slot and keep it only if the owning thread did not touch it meanwhile
+      uint32_t sequence = event.sequence.load(std::memory_order_acquire);
+      copy.phase = event.phase;
+      copy.kind = event.kind;
+      memcpy(copy.name, event.name, sizeof(copy.name));
+      copy.tid = event.tid;
+      copy.startNs = event.startNs;
+      copy.durationNs = event.durationNs;
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if ((sequence & 1) != 0 || event.sequence.load(std::memory_order_relaxed) != sequence) {
+        continue;
+      }
+      if (copy.startNs < sessionStartNs) {
+        continue;
+      }
+      copy.name[sizeof(copy.name) - 1] = '\0';
+      os << (first ? "\n" : ",\n") << "{\"name\":";
+      appendJsonString(os, copy.name);
+      os << ",\"cat\":";
+      appendJsonString(os, copy.kind);
+      char times[96];
+      if (copy.phase == 'X') {
+        snprintf(times, sizeof(times), ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f", copy.startNs / 1000.0, copy.durationNs / 1000.0);
+      } else {
+        snprintf(times, sizeof(times), ",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f", copy.startNs / 1000.0);
+      }
+      os << times << ",\"pid\":" << pid << ",\"tid\":" << copy.tid << "}";
+      first = false;
+    }
+  }
+  os << "\n]}\n";
+  return os.str();
+}
+
+bool JniTrace::writeChromeTrace(const std::string &path) {
+  std::string json = toChromeTrace();
+  FILE *file = fopen(path.c_str(), "w");
+  if (file == nullptr) {
+    return false;
+  }
+  bool written = fwrite(json.data(), 1, json.size(), file) == json.size();
+  return fclose(file) == 0 && written;
+}
+}  // namespace jnicpp11
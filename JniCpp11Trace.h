@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace jnicpp11 {
+
+/**
+ *  Optional timeline recording of JNI wrapper calls (call, staticCall, newObject, field access, jstring
+ *  conversions, class/member lookups and thread attach), exported as Chrome trace-event JSON. The file opens in
+ *  chrome://tracing and in the Perfetto UI.
+ *
+ *  JniTrace::start();
+ *  ...  // a few frames, with JniTrace::instant("frame") at frame boundaries
+ *  JniTrace::stop();
+ *  JniTrace::writeChromeTrace(filesDir + "/jni_trace.json");
+ *
+ *  Every thread records into its own ring buffer, so the oldest spans of a thread are overwritten once the buffer
+ *  is full. The buffer of an exited thread is reused by the next thread that starts recording, which overwrites its
+ *  spans oldest first. While tracing is stopped a span costs a single relaxed atomic load. Define JNICPP11_NO_TRACE to
+ *  compile the spans out entirely.
+ */
+class JniTrace {
+ public:
+  // Starts a new recording; spans recorded before are not exported anymore.
+  static void start();
+  static void stop();
+  static bool isEnabled() { return _enabled.load(std::memory_order_relaxed); }
+
+  // Ring buffer size for threads that record their first span after this call. Default 8192 spans.
+  static void setBufferCapacity(size_t spansPerThread);
+
+  // Zero-duration marker, e.g. a frame boundary.
+  static void instant(const char *name);
+
+  // Spans of threads still recording may be missing; call stop() first for a complete trace.
+  static std::string toChromeTrace();
+  static bool writeChromeTrace(const std::string &path);
+
+  class Span {
+   public:
+    explicit Span(const char *kind, const std::string *detail = nullptr)
+        : _kind(kind), _detail(detail), _startNs(isEnabled() ? now() : 0) {}
+    Span(const char *kind, const std::string &detail) : Span(kind, &detail) {}
+    Span(const Span &) = delete;
+    Span &operator=(const Span &) = delete;
+    ~Span() {
+      if (_startNs != 0) {
+        record(_kind, _detail, _startNs);
+      }
+    }
+
+   private:
+    const char *_kind;
+    const std::string *_detail;
+    uint64_t _startNs;
+  };
+
+ private:
+  static uint64_t now();
+  static void record(const char *kind, const std::string *detail, uint64_t startNs);
+
+  static std::atomic<bool> _enabled;
+};
+}  // namespace jnicpp11
+
+#define JNICPP11_TRACE_CONCAT_(A, B) A##B
+#define JNICPP11_TRACE_CONCAT(A, B) JNICPP11_TRACE_CONCAT_(A, B)
+
+// Records the enclosing scope as a span: JNICPP11_TRACE_SPAN("call", methodName);
+#ifndef JNICPP11_NO_TRACE
+#define JNICPP11_TRACE_SPAN(...) ::jnicpp11::JniTrace::Span JNICPP11_TRACE_CONCAT(jnicpp11TraceSpan, __LINE__)(__VA_ARGS__)
+#else
+#define JNICPP11_TRACE_SPAN(...) \
+  do {                           \
+  } while (0)
+#endif
@@ -0,0 +1,304 @@
+package org.jnicpp11;
+
+import java.lang.reflect.Constructor;
+import java.lang.reflect.InvocationTargetException;
+import java.lang.reflect.Method;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.charset.Charset;
+import java.util.ArrayList;
+import java.util.Arrays;
+
+/**
+ * Executes a batch of void method calls encoded by JniCpp11's JavaCommandBatch, so that many small calls cost a single
+ * JNI crossing.
+ *
+ * <p>The buffer is native memory owned by the C++ side. Targets and methods are registered once and referred to by index.
+ * Each command is encoded in native byte order as:
+ *
+ * <pre>
+ * int target (-1 for static methods), int method, int argCount, then per argument a one byte tag followed by
+ *   'Z' 'B' byte | 'C' 'S' short | 'I' 'F' int/float | 'J' 'D' long/double | 'T' int length + UTF-8 bytes
+ *   'O' int target index | 'N' nothing (null)
+ * </pre>
+ *
+ * <p>Methods with up to {@value #MAX_PRIMITIVES} primitive and {@value #MAX_OBJECTS} object parameters are called
+ * through {@link MethodHandleInvoker}, which passes primitive arguments as raw long bits, so they are neither boxed nor
+ * copied into an array. Other methods go through Method.invoke, and so do all methods when MethodHandleInvoker is not
+ * compiled into the app (it needs Android API 26).
+ */
+public final class CommandBatch {
+  private static final Charset UTF_8 = Charset.forName("UTF-8");
+  static final int MAX_PRIMITIVES = 6;
+  static final int MAX_OBJECTS = 4;
+  private static final Constructor<?> INVOKER_CONSTRUCTOR = invokerConstructor();
+  // primitive types in widening order, as applied by Method.invoke; char widens to int and up
+  private static final String WIDENING = "BSIJFD";
+
+  private final ByteBuffer buffer;
+  private final ArrayList<Object> targets = new ArrayList<>();
+  private final ArrayList<Command> methods = new ArrayList<>();
+  private final ArrayList<Object[]> argumentArrays = new ArrayList<>();
+  private final long[] primitives = new long[MAX_PRIMITIVES];
+  private final Object[] objects = new Object[MAX_OBJECTS];
+
+  public CommandBatch(ByteBuffer buffer) {
+    this.buffer = buffer.order(ByteOrder.nativeOrder());
+  }
+
+  public int addTarget(Object target) {
+    targets.add(target);
+    return targets.size() - 1;
+  }
+
+  public int addMethod(Method method) {
+    method.setAccessible(true);
+    methods.add(new Command(method));
+    return methods.size() - 1;
+  }
+
+  /**
+   * Runs the commands in the first length bytes of the buffer. A failing command does not stop the batch.
+   *
+   * @return null if every command succeeded, otherwise a description of the first failure
+   */
+  public String execute(int length) {
+    String firstError = null;
+    int position = 0;
+    while (position < length) {
+      int targetIndex = buffer.getInt(position);
+      Object target = targetIndex < 0 ? null : targets.get(targetIndex);
+      Command command = methods.get(buffer.getInt(position + 4));
+      int argCount = buffer.getInt(position + 8);
+      position += 12;
+      int end = skipArguments(position, argCount);
+      if (end < 0) {
+        return "CommandBatch: corrupt buffer, unknown argument tag";
+      }
+      try {
+        if (command.invoker != null) {
+          invokeHandle(command, target, position, argCount);
+        } else {
+          invokeMethod(command.method, target, position, argCount);
+        }
+      } catch (InvocationTargetException e) {
+        firstError = firstError != null ? firstError : command.method + " threw " + e.getCause();
+      } catch (Throwable e) {
+        // Method.invoke wraps errors thrown by the method as well; neither stops the batch
+        firstError = firstError != null ? firstError : command.method + ": " + e;
+      }
+      position = end;
+    }
+    return firstError;
+  }
+
+  private void invokeHandle(Command command, Object target, int position, int argCount) throws Throwable {
+    char[] kinds = command.kinds;
+    if (argCount != kinds.length) {
+      throw new IllegalArgumentException("wrong number of arguments");
+    }
+    int primitiveCount = 0;
+    int objectCount = 0;
+    try {
+      for (int i = 0; i < argCount; ++i) {
+        byte tag = buffer.get(position);
+        if (kinds[i] == 'L') {
+          objects[objectCount++] = objectArgument(tag, position + 1);
+        } else {
+          primitives[primitiveCount++] = primitiveArgument(tag, position + 1, kinds[i]);
+        }
+        position = skipArgument(tag, position);
+      }
+      command.invoker.invoke(target, primitives, objects);
+    } finally {
+      Arrays.fill(objects, null);
+    }
+  }
+
+  private void invokeMethod(Method method, Object target, int position, int argCount) throws Exception {
+    Object[] args = argumentArray(argCount);
+    try {
+      for (int i = 0; i < argCount; ++i) {
+        byte tag = buffer.get(position);
+        args[i] = objectArgument(tag, position + 1);
+        position = skipArgument(tag, position);
+      }
+      method.invoke(target, args);
+    } finally {
+      Arrays.fill(args, null);
+    }
+  }
+
+  // Returns the argument widened to the primitive parameter type, as bits that MethodHandleInvoker narrows back to that
+  // type; floats and doubles as their IEEE bits.
+  private long primitiveArgument(byte tag, int position, char kind) {
+    if (tag == kind) {
+      switch (tag) {
+        case 'Z':
+          return buffer.get(position) != 0 ? 1 : 0;
+        case 'B':
+          return buffer.get(position);
+        case 'C':
+          return buffer.getChar(position);
+        case 'S':
+          return buffer.getShort(position);
+        case 'I':
+        case 'F':
+          return buffer.getInt(position);
+        default:
+          return buffer.getLong(position);
+      }
+    }
+    if (!widensTo(tag, kind)) {
+      throw new IllegalArgumentException("argument type mismatch: " + (char) tag + " for " + kind);
+    }
+    if (tag == 'F') {
+      return Double.doubleToRawLongBits(buffer.getFloat(position));
+    }
+    long value = primitiveArgument(tag, position, (char) tag);
+    switch (kind) {
+      case 'F':
+        return Float.floatToRawIntBits((float) value);
+      case 'D':
+        return Double.doubleToRawLongBits((double) value);
+      default:
+        return value;
+    }
+  }
+
+  private static boolean widensTo(byte tag, char kind) {
+    if (tag == 'C') {
+      return "IJFD".indexOf(kind) >= 0;
+    }
+    int rank = WIDENING.indexOf(tag);
+    return rank >= 0 && WIDENING.indexOf(kind) > rank;
+  }
+
+  private Object objectArgument(byte tag, int position) {
+    switch (tag) {
+      case 'Z':
+        return buffer.get(position) != 0;
+      case 'B':
+        return buffer.get(position);
+      case 'C':
+        return buffer.getChar(position);
+      case 'S':
+        return buffer.getShort(position);
+      case 'I':
+        return buffer.getInt(position);
+      case 'F':
+        return buffer.getFloat(position);
+      case 'J':
+        return buffer.getLong(position);
+      case 'D':
+        return buffer.getDouble(position);
+      case 'T':
+        return readString(position + 4, buffer.getInt(position));
+      case 'O':
+        return targets.get(buffer.getInt(position));
+      default:
+        return null;
+    }
+  }
+
+  // Returns the position after the argument starting with its tag at position, or -1 for an unknown tag.
+  private int skipArgument(byte tag, int position) {
+    switch (tag) {
+      case 'Z':
+      case 'B':
+        return position + 2;
+      case 'C':
+      case 'S':
+        return position + 3;
+      case 'I':
+      case 'F':
+      case 'O':
+        return position + 5;
+      case 'J':
+      case 'D':
+        return position + 9;
+      case 'T':
+        return position + 5 + buffer.getInt(position + 1);
+      case 'N':
+        return position + 1;
+      default:
+        return -1;
+    }
+  }
+
+  private int skipArguments(int position, int argCount) {
+    for (int i = 0; i < argCount && position >= 0; ++i) {
+      position = skipArgument(buffer.get(position), position);
+    }
+    return position;
+  }
+
+  private Object[] argumentArray(int count) {
+    while (argumentArrays.size() <= count) {
+      argumentArrays.add(new Object[argumentArrays.size()]);
+    }
+    return argumentArrays.get(count);
+  }
+
+  private String readString(int position, int length) {
+    byte[] bytes = new byte[length];
+    ByteBuffer view = buffer.duplicate();
+    view.position(position);
+    view.get(bytes);
+    return new String(bytes, UTF_8);
+  }
+
+  private static final class Command {
+    final Method method;
+    // per parameter the primitive type descriptor, or 'L' for objects
+    final char[] kinds;
+    final Invoker invoker;
+
+    Command(Method method) {
+      this.method = method;
+      Class<?>[] parameterTypes = method.getParameterTypes();
+      kinds = new char[parameterTypes.length];
+      int primitiveCount = 0;
+      for (int i = 0; i < parameterTypes.length; ++i) {
+        kinds[i] = descriptor(parameterTypes[i]);
+        primitiveCount += kinds[i] != 'L' ? 1 : 0;
+      }
+      Invoker invoker = null;
+      boolean fits = primitiveCount <= MAX_PRIMITIVES && kinds.length - primitiveCount <= MAX_OBJECTS;
+      if (INVOKER_CONSTRUCTOR != null && fits) {
+        try {
+          invoker = (Invoker) INVOKER_CONSTRUCTOR.newInstance(method, kinds);
+        } catch (Exception | LinkageError e) {
+          // the method cannot be adapted: use Method.invoke
+        }
+      }
+      this.invoker = invoker;
+    }
+
+    private static char descriptor(Class<?> type) {
+      if (!type.isPrimitive()) {
+        return 'L';
+      }
+      if (type == boolean.class) {
+        return 'Z';
+      }
+      if (type == long.class) {
+        return 'J';
+      }
+      return Character.toUpperCase(type.getName().charAt(0));
+    }
+  }
+
+  /** A method adapted to take primitive arguments without boxing, see {@link MethodHandleInvoker}. */
+  interface Invoker {
+    void invoke(Object target, long[] primitives, Object[] objects) throws Throwable;
+  }
+
+  private static Constructor<?> invokerConstructor() {
+    try {
+      return Class.forName("org.jnicpp11.MethodHandleInvoker").getDeclaredConstructor(Method.class, char[].class);
+    } catch (Exception | LinkageError e) {
+      return null;
+    }
+  }
+}
@@ -0,0 +1,70 @@
+package org.jnicpp11;
+
+import java.lang.invoke.MethodHandle;
+import java.lang.invoke.MethodHandles;
+import java.lang.invoke.MethodType;
+import java.lang.reflect.Method;
+import java.lang.reflect.Modifier;
+
+/**
+ * Calls a method registered with {@link CommandBatch} through a MethodHandle adapted to one fixed type, (Object target,
+ * long x MAX_PRIMITIVES, Object x MAX_OBJECTS)void. The nth primitive parameter takes the nth long, the nth object
+ * parameter the nth Object, and unused arguments are dropped.
+ *
+ * <p>Optional: leave this file out of apps with a minSdkVersion below 26, where D8 rejects MethodHandle.invokeExact.
+ * CommandBatch then calls every method through Method.invoke.
+ */
+final class MethodHandleInvoker implements CommandBatch.Invoker {
+  private static final MethodType TYPE = MethodType.methodType(
+      void.class,
+      Object.class,
+      long.class, long.class, long.class, long.class, long.class, long.class,
+      Object.class, Object.class, Object.class, Object.class);
+
+  private final MethodHandle handle;
+
+  MethodHandleInvoker(Method method, char[] kinds) throws ReflectiveOperationException {
+    MethodHandles.Lookup lookup = MethodHandles.lookup();
+    MethodHandle handle = lookup.unreflect(method);
+    if (Modifier.isStatic(method.getModifiers())) {
+      handle = MethodHandles.dropArguments(handle, 0, Object.class);
+    }
+    MethodHandle intBitsToFloat =
+        lookup.findStatic(Float.class, "intBitsToFloat", MethodType.methodType(float.class, int.class));
+    MethodHandle longBitsToDouble =
+        lookup.findStatic(Double.class, "longBitsToDouble", MethodType.methodType(double.class, long.class));
+    Class<?>[] slotTypes = new Class<?>[kinds.length + 1];
+    int[] reorder = new int[kinds.length + 1];
+    slotTypes[0] = Object.class;
+    int primitiveCount = 0;
+    int objectCount = 0;
+    for (int i = 0; i < kinds.length; ++i) {
+      if (kinds[i] == 'F') {
+        handle = MethodHandles.filterArguments(handle, i + 1, intBitsToFloat);
+      } else if (kinds[i] == 'D') {
+        handle = MethodHandles.filterArguments(handle, i + 1, longBitsToDouble);
+      }
+      if (kinds[i] == 'L') {
+        slotTypes[i + 1] = Object.class;
+        reorder[i + 1] = 1 + CommandBatch.MAX_PRIMITIVES + objectCount++;
+      } else {
+        slotTypes[i + 1] = long.class;
+        reorder[i + 1] = 1 + primitiveCount++;
+      }
+    }
+    if (primitiveCount > CommandBatch.MAX_PRIMITIVES || objectCount > CommandBatch.MAX_OBJECTS) {
+      throw new IllegalArgumentException("too many parameters: " + method);
+    }
+    // narrows the longs to the parameter types (booleans take the lowest bit) and casts the target and objects
+    handle = MethodHandles.explicitCastArguments(handle, MethodType.methodType(void.class, slotTypes));
+    this.handle = MethodHandles.permuteArguments(handle, TYPE, reorder);
+  }
+
+  @Override
+  public void invoke(Object target, long[] primitives, Object[] objects) throws Throwable {
+    handle.invokeExact(
+        target,
+        primitives[0], primitives[1], primitives[2], primitives[3], primitives[4], primitives[5],
+        objects[0], objects[1], objects[2], objects[3]);
+  }
+}
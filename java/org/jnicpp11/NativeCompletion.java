@@ -0,0 +1,94 @@
+package org.jnicpp11;
+
+import java.lang.reflect.InvocationHandler;
+import java.lang.reflect.Method;
+import java.lang.reflect.Proxy;
+import java.util.concurrent.CompletionStage;
+import java.util.function.BiConsumer;
+
+/**
+ * Forwards the completion of a Java async operation to a native callback registered by JniCpp11's JavaAsync.
+ *
+ * <p>The native callback is consumed by the first completion; later completions are ignored.
+ */
+public final class NativeCompletion implements BiConsumer<Object, Throwable>, InvocationHandler {
+  private long handle;
+  private final String successMethod;
+  private final String failureMethod;
+
+  private NativeCompletion(long handle, String successMethod, String failureMethod) {
+    this.handle = handle;
+    this.successMethod = successMethod;
+    this.failureMethod = failureMethod;
+  }
+
+  public static void whenComplete(CompletionStage<?> stage, long handle) {
+    stage.whenComplete(new NativeCompletion(handle, null, null));
+  }
+
+  public static Object listener(Class<?> listenerInterface, String successMethod, String failureMethod, long handle) {
+    return Proxy.newProxyInstance(
+        listenerInterface.getClassLoader(),
+        new Class<?>[] {listenerInterface},
+        new NativeCompletion(handle, successMethod, failureMethod));
+  }
+
+  @Override
+  public void accept(Object result, Throwable error) {
+    complete(result, error, error != null);
+  }
+
+  @Override
+  public Object invoke(Object proxy, Method method, Object[] args) {
+    String name = method.getName();
+    Object firstArg = args == null || args.length == 0 ? null : args[0];
+    if (method.getDeclaringClass() == Object.class) {
+      if (name.equals("equals")) {
+        return proxy == firstArg;
+      } else if (name.equals("hashCode")) {
+        return System.identityHashCode(proxy);
+      }
+      return "NativeCompletion(" + successMethod + ", " + failureMethod + ")";
+    }
+    if (name.equals(successMethod)) {
+      complete(firstArg, null, false);
+    } else if (name.equals(failureMethod)) {
+      complete(null, firstArg, true);
+    }
+    return defaultValue(method.getReturnType());
+  }
+
+  private void complete(Object result, Object error, boolean failed) {
+    long callback;
+    synchronized (this) {
+      callback = handle;
+      handle = 0;
+    }
+    if (callback != 0) {
+      nativeComplete(callback, result, error, failed);
+    }
+  }
+
+  private static Object defaultValue(Class<?> type) {
+    if (!type.isPrimitive() || type == void.class) {
+      return null;
+    } else if (type == boolean.class) {
+      return false;
+    } else if (type == char.class) {
+      return '\0';
+    } else if (type == byte.class) {
+      return (byte) 0;
+    } else if (type == short.class) {
+      return (short) 0;
+    } else if (type == int.class) {
+      return 0;
+    } else if (type == long.class) {
+      return 0L;
+    } else if (type == float.class) {
+      return 0f;
+    }
+    return 0d;
+  }
+
+  private static native void nativeComplete(long handle, Object result, Object error, boolean failed);
+}
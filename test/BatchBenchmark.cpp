@@ -0,0 +1,176 @@
+/**
+ *  Checks that JavaCommandBatch passes every argument type through both dispatch paths of CommandBatch.java, then
+ *  prints the cost per call of batched calls against one JNI call each, for several batch sizes:
+ *
+ *  javac -d /tmp/jnicpp11_classes java/org/jnicpp11/CommandBatch.java java/org/jnicpp11/MethodHandleInvoker.java \
+ *    test/BatchTarget.java
+ *  g++ -std=c++11 -O2 -I. -I$JAVA_HOME/include -I$JAVA_HOME/include/linux test/BatchBenchmark.cpp JniCpp11*.cpp \
+ *    -L$JAVA_HOME/lib/server -ljvm -Wl,-rpath,$JAVA_HOME/lib/server -lpthread -o batch_benchmark \
+ *    && ./batch_benchmark /tmp/jnicpp11_classes
+ */
+
+#include <chrono>
+
+#include "JniCpp11Batch.h"
+#include "test/TestJvm.h"
+
+using namespace jnicpp11;
+
+namespace {
+const int kBenchmarkCalls = 1 << 20;
+
+struct Methods {
+  jmethodID add;
+  jmethodID setAlpha;
+  jmethodID setText;
+};
+
+void testArguments(const JavaClass &targetClass) {
+  JavaCommandBatch batch;
+  JavaObject target = targetClass.newObject();
+  auto handle = batch.addTarget(target);
+  auto add = batch.addMethod(targetClass, "add", "(I)V");
+  auto setAlpha = batch.addMethod(targetClass, "setAlpha", "(F)V");
+  auto setText = batch.addMethod(targetClass, "setText", "(Ljava/lang/String;)V");
+  auto widen = batch.addMethod(targetClass, "widen", "(JFD)V");
+  auto setAll = batch.addMethod(targetClass, "setAll", "(ZBCSIJFD)V");
+  auto tick = batch.addStaticMethod(targetClass, "tick", "()V");
+
+  TEST_CHECK(batch.callVoid(handle, add, (jint)-7));
+  TEST_CHECK(batch.callVoid(handle, add, (jint)3));
+  TEST_CHECK(batch.callVoid(handle, setAlpha, 0.25f));
+  TEST_CHECK(batch.callVoid(handle, setText, std::string("Score: 42")));
+  TEST_CHECK(batch.callVoid(handle, widen, (jint)-5, (jint)3, 0.5f));
+  TEST_CHECK(batch.callVoid(handle, setAll, true, (jbyte)1, (jchar)'c', (jshort)2, (jint)3, (jlong)4, 5.5f, 6.5));
+  TEST_CHECK(batch.staticCallVoid(tick));
+  TEST_CHECK(batch.size() == 7);
+  TEST_CHECK(batch.flush());
+  TEST_CHECK(target.field("count", (jint)0) == 2);
+  TEST_CHECK(target.field("sum", (jlong)0) == -4);
+  TEST_CHECK(target.field("alpha", 0.0f) == 0.25f);
+  TEST_CHECK(fromJString(target.field("text", JavaObject::null("java/lang/String"))) == "Score: 42");
+  TEST_CHECK(target.field("wideLong", (jlong)0) == -5);
+  TEST_CHECK(target.field("wideFloat", 0.0f) == 3.0f);
+  TEST_CHECK(target.field("wideDouble", 0.0) == 0.5);
+  TEST_CHECK(fromJString(target.field("all", JavaObject::null("java/lang/String"))) == "true 1 c 2 3 4 5.5 6.5");
+  TEST_CHECK(targetClass.staticField("ticks", (jint)0) == 1);
+
+  // null strings arrive as null, and a narrowing conversion fails only its own command
+  TEST_CHECK(batch.callVoid(handle, setText, (const char *)nullptr));
+  TEST_CHECK(batch.callVoid(handle, add, (jlong)1));
+  TEST_CHECK(batch.callVoid(handle, add, (jint)1));
+  TEST_CHECK(!batch.flush());
+  TEST_CHECK(!target.field("text", JavaObject::null("java/lang/String")));
+  TEST_CHECK(target.field("count", (jint)0) == 3);
+
+  // the handle addTarget returns on failure is rejected, not recorded as a static call
+  TEST_CHECK(!batch.callVoid(JavaCommandBatch::Target{-1}, add, (jint)1));
+  TEST_CHECK(batch.size() == 0);
+
+  // a mutable char array is sized as the string it holds: this one does not fit after the two adds, so the batch
+  // flushes them first instead of writing past its end
+  JavaCommandBatch small(64);
+  auto smallHandle = small.addTarget(target);
+  auto smallAdd = small.addMethod(targetClass, "add", "(I)V");
+  auto smallSetText = small.addMethod(targetClass, "setText", "(Ljava/lang/String;)V");
+  char text[] = "twenty characters...";
+  TEST_CHECK(small.callVoid(smallHandle, smallAdd, (jint)1));
+  TEST_CHECK(small.callVoid(smallHandle, smallAdd, (jint)1));
+  TEST_CHECK(small.callVoid(smallHandle, smallSetText, text));
+  TEST_CHECK(small.size() == 1);
+  TEST_CHECK(small.flush());
+  TEST_CHECK(target.field("count", (jint)0) == 5);
+  TEST_CHECK(fromJString(target.field("text", JavaObject::null("java/lang/String"))) == text);
+}
+
+template <typename Work> double nanosecondsPerCall(Work work) {
+  auto start = std::chrono::steady_clock::now();
+  work();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e9 / kBenchmarkCalls;
+}
+
+void benchmark(const JavaClass &targetClass, const Methods &methods) {
+  JavaCommandBatch batch(1 << 20);
+  JavaObject target = targetClass.newObject();
+  auto handle = batch.addTarget(target);
+  auto add = batch.addMethod(targetClass, "add", "(I)V");
+  auto setAlpha = batch.addMethod(targetClass, "setAlpha", "(F)V");
+  auto setText = batch.addMethod(targetClass, "setText", "(Ljava/lang/String;)V");
+  std::string text = "Score: 42";
+
+  double perCall[3] = {
+      nanosecondsPerCall([&] {
+        for (int i = 0; i < kBenchmarkCalls; ++i) {
+          target.callVoid(methods.add, (jint)i);
+        }
+      }),
+      nanosecondsPerCall([&] {
+        for (int i = 0; i < kBenchmarkCalls; ++i) {
+          target.callVoid(methods.setAlpha, 0.5f);
+        }
+      }),
+      nanosecondsPerCall([&] {
+        for (int i = 0; i < kBenchmarkCalls; ++i) {
+          target.callVoid(methods.setText, text);
+        }
+      }),
+  };
+  printf("batch size  add(int)  setAlpha(float)  setText(String)  (ns per call)\n");
+  printf("%10s  %8.1f  %15.1f  %15.1f\n", "per call", perCall[0], perCall[1], perCall[2]);
+  for (int batchSize = 1; batchSize <= 1000; batchSize *= 10) {
+    double batched[3] = {
+        nanosecondsPerCall([&] {
+          for (int i = 0; i < kBenchmarkCalls; ++i) {
+            batch.callVoid(handle, add, (jint)i);
+            if (i % batchSize == batchSize - 1) {
+              batch.flush();
+            }
+          }
+          batch.flush();
+        }),
+        nanosecondsPerCall([&] {
+          for (int i = 0; i < kBenchmarkCalls; ++i) {
+            batch.callVoid(handle, setAlpha, 0.5f);
+            if (i % batchSize == batchSize - 1) {
+              batch.flush();
+            }
+          }
+          batch.flush();
+        }),
+        nanosecondsPerCall([&] {
+          for (int i = 0; i < kBenchmarkCalls; ++i) {
+            batch.callVoid(handle, setText, text);
+            if (i % batchSize == batchSize - 1) {
+              batch.flush();
+            }
+          }
+          batch.flush();
+        }),
+    };
+    printf("%10d  %8.1f  %15.1f  %15.1f\n", batchSize, batched[0], batched[1], batched[2]);
+  }
+  TEST_CHECK(target.field("count", (jint)0) == 5 * kBenchmarkCalls);
+}
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    printf("usage: %s <directory with the compiled CommandBatch and BatchTarget classes>\n", argv[0]);
+    return 1;
+  }
+  JNIEnv *env = test::startJvm({std::string("-Djava.class.path=") + argv[1]});
+  if (env == nullptr || !JavaCommandBatch::init()) {
+    return 1;
+  }
+  JavaClass targetClass = JavaClass::getClass("BatchTarget");
+  TEST_CHECK(targetClass);
+  if (targetClass) {
+    jclass clazz = targetClass.getJClass();
+    Methods methods = {env->GetMethodID(clazz, "add", "(I)V"),
+                       env->GetMethodID(clazz, "setAlpha", "(F)V"),
+                       env->GetMethodID(clazz, "setText", "(Ljava/lang/String;)V")};
+    testArguments(targetClass);
+    benchmark(targetClass, methods);
+  }
+  return test::finish("batch");
+}
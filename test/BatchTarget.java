@@ -0,0 +1,41 @@
+/** Methods called by test/BatchBenchmark.cpp, one per dispatch path of org.jnicpp11.CommandBatch. */
+public class BatchTarget {
+  public static int ticks;
+
+  public int count;
+  public long sum;
+  public float alpha;
+  public String text = "unset";
+  public long wideLong;
+  public float wideFloat;
+  public double wideDouble;
+  public String all;
+
+  public static void tick() {
+    ++ticks;
+  }
+
+  public void add(int value) {
+    ++count;
+    sum += value;
+  }
+
+  public void setAlpha(float alpha) {
+    this.alpha = alpha;
+  }
+
+  public void setText(String text) {
+    this.text = text;
+  }
+
+  public void widen(long wideLong, float wideFloat, double wideDouble) {
+    this.wideLong = wideLong;
+    this.wideFloat = wideFloat;
+    this.wideDouble = wideDouble;
+  }
+
+  // more primitive parameters than the MethodHandle path takes, so it goes through Method.invoke
+  public void setAll(boolean z, byte b, char c, short s, int i, long j, float f, double d) {
+    all = z + " " + b + " " + c + " " + s + " " + i + " " + j + " " + f + " " + d;
+  }
+}
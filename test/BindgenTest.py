@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+"""Checks tools/jnicpp11_bindgen.py on class files assembled here, so that no Java compiler is needed: Java names that
+would override or hide JavaObject members, and object types of classes bound in the same run. The generated header is
+then compiled, once as is and once with a wrong wrapper type passed, which must not compile:
+
+  JAVA_HOME=/path/to/jdk python3 test/BindgenTest.py
+"""
+
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+
+REPO = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+sys.path.insert(0, os.path.join(REPO, 'tools'))
+
+import jnicpp11_bindgen  # noqa: E402
+
+ACC_PUBLIC = 0x0001
+ACC_STATIC = 0x0008
+
+
+def class_file(name, methods=(), fields=()):
+    """A class file with the given (access, name, descriptor) members and no code, which is all the generator reads."""
+    pool = []
+    indices = {}
+
+    def utf8(value):
+        if ('utf8', value) not in indices:
+            encoded = value.encode('utf-8')
+            pool.append(struct.pack('>BH', 1, len(encoded)) + encoded)
+            indices[('utf8', value)] = len(pool)
+        return indices[('utf8', value)]
+
+    def clazz(value):
+        name_index = utf8(value)
+        pool.append(struct.pack('>BH', 7, name_index))
+        return len(pool)
+
+    this_class = clazz(name)
+    super_class = clazz('java/lang/Object')
+    members = []
+    for group in (fields, methods):
+        encoded = [struct.pack('>HHHH', access, utf8(member), utf8(descriptor), 0)
+                   for access, member, descriptor in group]
+        members.append(struct.pack('>H', len(encoded)) + b''.join(encoded))
+    return (struct.pack('>IHHH', 0xCAFEBABE, 0, 50, len(pool) + 1) + b''.join(pool) +
+            struct.pack('>HHHH', ACC_PUBLIC, this_class, super_class, 0) + members[0] + members[1] +
+            struct.pack('>H', 0))
+
+
+PLAYER = class_file('com/example/Player', methods=[
+    (ACC_PUBLIC, '<init>', '(Ljava/lang/String;)V'),
+    (ACC_PUBLIC, 'getClassPath', '()Ljava/lang/String;'),
+    (ACC_PUBLIC, 'getTypeSignature', '()Ljava/lang/String;'),
+    (ACC_PUBLIC, 'toGlobalRef', '()V'),
+    (ACC_PUBLIC | ACC_STATIC, 'borrow', '(Lcom/example/Player;)V'),
+    (ACC_PUBLIC, 'getScore', '()I'),
+    (ACC_PUBLIC, 'getTeam', '()Lcom/example/Team;'),
+    (ACC_PUBLIC, 'copy', '()Lcom/example/Player;'),
+    (ACC_PUBLIC, 'isTeammate', '(Lcom/example/Player;)Z'),
+    (ACC_PUBLIC, 'getAgent', '()Lcom/other/Agent;'),
+], fields=[
+    (ACC_PUBLIC, 'team', 'Lcom/example/Team;'),
+])
+
+TEAM = class_file('com/example/Team', methods=[
+    (ACC_PUBLIC, '<init>', '(Lcom/example/Player;)V'),
+    (ACC_PUBLIC, 'getCaptain', '()Lcom/example/Player;'),
+    (ACC_PUBLIC, 'add', '(Lcom/example/Player;)V'),
+    (ACC_PUBLIC, 'add', '(Lcom/example/Team;)V'),
+    (ACC_PUBLIC | ACC_STATIC, 'merge', '(Lcom/example/Team;Lcom/example/Team;)Lcom/example/Team;'),
+])
+
+USAGE = r'''
+#include "Bindings.h"
+
+using bindings::com::example::Player;
+using bindings::com::example::Team;
+
+void use(const Player &player) {
+  Team team = player.getTeam();
+  Player captain = team.getCaptain();
+  Player copy = captain.copy();
+  jboolean teammate = player.isTeammate(copy);
+  team.add(player);
+  team.add(Team::create(captain));
+  Team merged = Team::merge(team, team);
+  jnicpp11::JavaObject agent = player.getAgent();
+  Player::borrow_(player);
+  std::string classPath = player.getClassPath();
+  std::string name = player.getClassPath_();
+  jnicpp11::JavaField<jnicpp11::JavaObject> teamField = Player::teamField();
+  (void)teammate, (void)merged, (void)agent, (void)classPath, (void)name, (void)teamField;
+#ifdef WRONG_TYPE
+  player.isTeammate(team);
+#endif
+}
+'''
+
+failures = 0
+
+
+def check(condition, message):
+    global failures
+    if not condition:
+        print('FAIL %s' % message)
+        failures += 1
+
+
+def compile_header(directory, header, defines=()):
+    java_home = os.environ['JAVA_HOME']
+    with open(os.path.join(directory, 'Bindings.h'), 'w') as f:
+        f.write(header)
+    with open(os.path.join(directory, 'use.cpp'), 'w') as f:
+        f.write(USAGE)
+    command = [os.environ.get('CXX', 'g++'), '-std=c++11', '-fsyntax-only', '-I', REPO, '-I', directory,
+               '-I', os.path.join(java_home, 'include'), '-I', os.path.join(java_home, 'include', 'linux')]
+    command += ['-D%s' % define for define in defines] + [os.path.join(directory, 'use.cpp')]
+    result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+    return result.returncode, result.stdout
+
+
+def main():
+    with tempfile.TemporaryDirectory() as directory:
+        for name, data in (('Player.class', PLAYER), ('Team.class', TEAM)):
+            with open(os.path.join(directory, name), 'wb') as f:
+                f.write(data)
+        classes = sorted(jnicpp11_bindgen.load_classes([directory]), key=lambda c: c.name)
+        header = jnicpp11_bindgen.generate(classes, 'bindings', [directory])
+
+        # JavaObject and JavaClass member names get a suffix instead of overriding or hiding them
+        code = '\n'.join(line for line in header.splitlines() if not line.lstrip().startswith('//'))
+        for name in ('getClassPath', 'getTypeSignature', 'toGlobalRef', 'borrow'):
+            check(' %s(' % name not in code, '%s is not reserved' % name)
+            check(' %s_(' % name in code, '%s_ is not generated' % name)
+
+        # classes of this run are typed, others stay JavaObject
+        check('::bindings::com::example::Team getTeam() const;' in header, 'getTeam does not return Team')
+        check('jboolean isTeammate(const ::bindings::com::example::Player &a0) const;' in header,
+              'isTeammate does not take a Player')
+        check('jnicpp11::JavaObject getAgent() const {' in header, 'getAgent does not return JavaObject')
+        check('static ::bindings::com::example::Team create(const ::bindings::com::example::Player &a0);' in header,
+              'Team::create does not take a Player')
+
+        if 'JAVA_HOME' not in os.environ:
+            print('JAVA_HOME is not set, skipping the compile checks')
+        else:
+            status, output = compile_header(directory, header)
+            check(status == 0, 'generated header does not compile:\n' + output)
+            status, output = compile_header(directory, header, ['WRONG_TYPE'])
+            check(status != 0, 'a Team passed for a Player compiles')
+
+    print('bindgen: all checks passed' if failures == 0 else 'bindgen: %d failures' % failures)
+    return 0 if failures == 0 else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,218 @@
+/**
+ *  Checks lazy class resolution: class paths FindClass cannot see, and many threads racing to resolve the same fresh
+ *  JavaClass. Then prints how resolved class lookups scale with the number of threads:
+ *
+ *  g++ -std=c++11 -O2 -I. -I$JAVA_HOME/include -I$JAVA_HOME/include/linux test/ClassTest.cpp JniCpp11*.cpp \
+ *    -L$JAVA_HOME/lib/server -ljvm -Wl,-rpath,$JAVA_HOME/lib/server -lpthread -o class_test && ./class_test
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "test/TestJvm.h"
+
+using namespace jnicpp11;
+
+namespace {
+const int kThreads = 8;
+const int kRounds = 200;
+const int kBenchmarkCalls = 200000;
+
+// public class jnicpp11.test.HiddenBase {} and public class jnicpp11.test.Hidden extends HiddenBase {}, without
+// constructors. They are defined in their own class loader, so FindClass cannot find them.
+const unsigned char kHiddenBaseClass[] = {
+    0xca, 0xfe, 0xba, 0xbe, 0x00, 0x00, 0x00, 0x32, 0x00, 0x05, 0x01, 0x00, 0x18, 0x6a, 0x6e, 0x69, 0x63, 0x70, 0x70,
+    0x31, 0x31, 0x2f, 0x74, 0x65, 0x73, 0x74, 0x2f, 0x48, 0x69, 0x64, 0x64, 0x65, 0x6e, 0x42, 0x61, 0x73, 0x65, 0x07,
+    0x00, 0x01, 0x01, 0x00, 0x10, 0x6a, 0x61, 0x76, 0x61, 0x2f, 0x6c, 0x61, 0x6e, 0x67, 0x2f, 0x4f, 0x62, 0x6a, 0x65,
+    0x63, 0x74, 0x07, 0x00, 0x03, 0x00, 0x21, 0x00, 0x02, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+const unsigned char kHiddenClass[] = {
+    0xca, 0xfe, 0xba, 0xbe, 0x00, 0x00, 0x00, 0x32, 0x00, 0x05, 0x01, 0x00, 0x14, 0x6a, 0x6e, 0x69, 0x63, 0x70,
+    0x70, 0x31, 0x31, 0x2f, 0x74, 0x65, 0x73, 0x74, 0x2f, 0x48, 0x69, 0x64, 0x64, 0x65, 0x6e, 0x07, 0x00, 0x01,
+    0x01, 0x00, 0x18, 0x6a, 0x6e, 0x69, 0x63, 0x70, 0x70, 0x31, 0x31, 0x2f, 0x74, 0x65, 0x73, 0x74, 0x2f, 0x48,
+    0x69, 0x64, 0x64, 0x65, 0x6e, 0x42, 0x61, 0x73, 0x65, 0x07, 0x00, 0x03, 0x00, 0x21, 0x00, 0x02, 0x00, 0x04,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+
+struct HiddenClasses {
+  JavaObject baseClass;
+  JavaObject hiddenClass;
+  JavaObject instance;
+};
+
+HiddenClasses defineHiddenClasses(JNIEnv *env) {
+  JavaClass urlClass = JavaClass::getClass("java/net/URL");
+  JavaArray<JavaObject> urls(env->NewObjectArray(0, urlClass.getJClass(), nullptr), urlClass);
+  JavaObject loader = JavaClass::getClass("java/net/URLClassLoader").newObject(urls);
+  JavaObject baseClass(env->DefineClass(
+      "jnicpp11/test/HiddenBase", loader.getJObject(), (const jbyte *)kHiddenBaseClass, sizeof(kHiddenBaseClass)));
+  JavaObject hiddenClass(
+      env->DefineClass("jnicpp11/test/Hidden", loader.getJObject(), (const jbyte *)kHiddenClass, sizeof(kHiddenClass)));
+  JavaObject instance(env->AllocObject((jclass)hiddenClass.getJObject()));
+  return HiddenClasses{baseClass.toGlobalRef(), hiddenClass.toGlobalRef(), instance.toGlobalRef()};
+}
+
+void testUnresolvableClassPath(JNIEnv *env, const HiddenClasses &classes) {
+  TEST_CHECK(!JavaClass::getClass("jnicpp11/test/Hidden"));
+  TEST_CHECK(!env->ExceptionCheck());
+
+  // the object's runtime class
+  JavaObject hidden(env->NewLocalRef(classes.instance.getJObject()), "jnicpp11/test/Hidden");
+  TEST_CHECK(env->IsSameObject(hidden.getJClass(), classes.hiddenClass.getJObject()));
+  TEST_CHECK(hidden.getClassPath() == "jnicpp11/test/Hidden");
+  std::string description = fromJString(hidden.call("toString", JavaObject::null("java/lang/String")));
+  TEST_CHECK(description.find("jnicpp11.test.Hidden@") == 0);
+
+  // a superclass, through the runtime class's loader; copies share the class published by the first
+  JavaObject base(env->NewLocalRef(classes.instance.getJObject()), "jnicpp11/test/HiddenBase");
+  JavaObject copy = base;
+  TEST_CHECK(env->IsSameObject(base.getJClass(), classes.baseClass.getJObject()));
+  TEST_CHECK(copy.getJClass() == base.getJClass());
+  TEST_CHECK(base.toGlobalRef().getJClass() == base.getJClass());
+
+  // a class no loader can see
+  JavaObject missing(env->NewLocalRef(classes.instance.getJObject()), "jnicpp11/test/Missing");
+  TEST_CHECK(missing.getJClass() == nullptr);
+  TEST_CHECK(!env->ExceptionCheck());
+}
+
+class Barrier {
+ public:
+  explicit Barrier(int count) : _count(count) {}
+
+  void wait() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    int generation = _generation;
+    if (++_waiting == _count) {
+      _waiting = 0;
+      ++_generation;
+      _condition.notify_all();
+    } else {
+      _condition.wait(lock, [&] { return generation != _generation; });
+    }
+  }
+
+ private:
+  std::mutex _mutex;
+  std::condition_variable _condition;
+  const int _count;
+  int _waiting = 0;
+  int _generation = 0;
+};
+
+// Every round, all threads resolve the class and class path of the same three fresh objects at once: one with a
+// class path FindClass finds, one without a class, and one whose class path only its class loader finds.
+void testConcurrentResolution(JNIEnv *env, const HiddenClasses &classes) {
+  JavaClass listClass = JavaClass::getClass("java/util/ArrayList");
+  JavaObject list = listClass.newObject().toGlobalRef();
+  JavaObject objects[3] = {nullptr, nullptr, nullptr};
+  jclass seen[kThreads][3];
+  std::string seenPaths[kThreads][3];
+  jint sizes[kThreads];
+  Barrier barrier(kThreads + 1);
+  std::atomic<int> mismatches{0};
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int round = 0; round < kRounds; ++round) {
+        barrier.wait();
+        for (int i = 0; i < 3; ++i) {
+          seen[t][i] = objects[i].getJClass();
+          seenPaths[t][i] = objects[i].getClassPath();
+        }
+        sizes[t] = objects[0].call("size", (jint)-1);
+        barrier.wait();
+      }
+    });
+  }
+
+  const char *expectedPaths[3] = {"java/util/ArrayList", "java/util/ArrayList", "jnicpp11/test/Hidden"};
+  for (int round = 0; round < kRounds; ++round) {
+    objects[0] = JavaObject(env->NewLocalRef(list.getJObject()), "java/util/ArrayList").toGlobalRef();
+    objects[1] = JavaObject(env->NewLocalRef(list.getJObject())).toGlobalRef();
+    objects[2] = JavaObject(env->NewLocalRef(classes.instance.getJObject()), "jnicpp11/test/Hidden").toGlobalRef();
+    barrier.wait();
+    barrier.wait();
+    for (int t = 0; t < kThreads; ++t) {
+      for (int i = 0; i < 3; ++i) {
+        if (seen[t][i] == nullptr || seen[t][i] != seen[0][i] || seenPaths[t][i] != expectedPaths[i]) {
+          ++mismatches;
+        }
+      }
+      if (sizes[t] != 0) {
+        ++mismatches;
+      }
+    }
+    TEST_CHECK(env->IsSameObject(seen[0][0], listClass.getJClass()));
+    TEST_CHECK(env->IsSameObject(seen[0][1], listClass.getJClass()));
+    TEST_CHECK(env->IsSameObject(seen[0][2], classes.hiddenClass.getJObject()));
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  for (JavaObject &object : objects) {
+    object = nullptr;
+  }
+  TEST_CHECK(mismatches == 0);
+}
+
+template <typename Work> double nanosecondsPerCall(int threadCount, Work work) {
+  Barrier barrier(threadCount + 1);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threadCount; ++t) {
+    threads.emplace_back([&] {
+      barrier.wait();
+      for (int i = 0; i < kBenchmarkCalls; ++i) {
+        work();
+      }
+      barrier.wait();
+    });
+  }
+  barrier.wait();
+  auto start = std::chrono::steady_clock::now();
+  barrier.wait();
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  return seconds * 1e9 / kBenchmarkCalls;
+}
+
+// One shared, already resolved JavaClass against what sharing used to require: a JavaClass per use, paying FindClass.
+void benchmarkSharedClass() {
+  JavaClass shared = JavaClass::getClass("java/util/ArrayList");
+  std::atomic<bool> failed{false};
+  printf("threads  shared getJClass  FindClass per use  (ns per call, per thread)\n");
+  for (int threadCount = 1; threadCount <= kThreads; threadCount *= 2) {
+    double sharedTime = nanosecondsPerCall(threadCount, [&] {
+      if (shared.getJClass() == nullptr) {
+        failed = true;
+      }
+    });
+    double findClassTime = nanosecondsPerCall(threadCount, [&] {
+      if (JavaClass::getClass("java/util/ArrayList").getJClass() == nullptr) {
+        failed = true;
+      }
+    });
+    printf("%7d  %16.1f  %17.1f\n", threadCount, sharedTime, findClassTime);
+  }
+  TEST_CHECK(!failed);
+}
+}
+
+int main() {
+  JNIEnv *env = test::startJvm();
+  if (env == nullptr) {
+    return 1;
+  }
+  HiddenClasses classes = defineHiddenClasses(env);
+  TEST_CHECK(classes.instance);
+  if (classes.instance) {
+    testUnresolvableClassPath(env, classes);
+    testConcurrentResolution(env, classes);
+  }
+  benchmarkSharedClass();
+  return test::finish("class");
+}
@@ -0,0 +1,180 @@
+/**
+ *  Checks every vectorized conversion kernel against its scalar version, bit for bit, for sizes 0 to 2 * the widest
+ *  vector width plus tails and for unaligned buffers, then prints the throughput of both. Needs no JVM:
+ *
+ *  g++ -std=c++11 -O2 -mf16c -I. -I$JAVA_HOME/include -I$JAVA_HOME/include/linux \
+ *    test/ConvertTest.cpp JniCpp11Convert.cpp -o convert_test && ./convert_test
+ *
+ *  Build it for the ARM ABIs (e.g. with the NDK toolchain, run through adb) to check the NEON kernels.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "JniCpp11Convert.h"
+
+using namespace jnicpp11;
+
+namespace {
+int g_failures = 0;
+
+// widest vector step of any kernel (unpackBits/packBits handle 16 elements per step), plus a few tails
+const size_t kMaxSize = 2 * 16 + 7;
+const size_t kBenchmarkSize = 1 << 16;
+
+std::mt19937 g_random(2024);
+
+template <typename T> bool sameBits(const T &a, const T &b) { return memcmp(&a, &b, sizeof(T)) == 0; }
+
+template <typename From, typename To>
+void check(const char *name,
+           void (*kernel)(const From *, To *, size_t),
+           void (*scalarKernel)(const From *, To *, size_t),
+           const std::vector<From> &input) {
+  for (size_t offset = 0; offset < 2; ++offset) {
+    for (size_t size = 0; size <= kMaxSize && offset + size <= input.size(); ++size) {
+      std::vector<To> expected(size + 1), actual(size + 1);
+      memset(&expected[0], 0x5a, expected.size() * sizeof(To));
+      memset(&actual[0], 0x5a, actual.size() * sizeof(To));
+      scalarKernel(&input[offset], &expected[0], size);
+      kernel(&input[offset], &actual[0], size);
+      // the extra element checks that nothing is written past size
+      for (size_t i = 0; i <= size; ++i) {
+        if (!sameBits(expected[i], actual[i])) {
+          printf("FAIL %s size %zu offset %zu element %zu\n", name, size, offset, i);
+          ++g_failures;
+          return;
+        }
+      }
+    }
+  }
+}
+
+template <typename From, typename To>
+void benchmark(const char *name,
+               void (*kernel)(const From *, To *, size_t),
+               void (*scalarKernel)(const From *, To *, size_t),
+               const std::vector<From> &input) {
+  std::vector<To> output(input.size());
+  double seconds[2];
+  for (int k = 0; k < 2; ++k) {
+    auto run = k == 0 ? scalarKernel : kernel;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < 200; ++round) {
+      run(&input[0], &output[0], input.size());
+    }
+    seconds[k] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+  double elements = 200.0 * input.size();
+  printf("%-14s scalar %7.0f M/s  kernel %7.0f M/s  x%.1f\n",
+         name,
+         elements / seconds[0] / 1e6,
+         elements / seconds[1] / 1e6,
+         seconds[0] / seconds[1]);
+}
+
+template <typename T> std::vector<T> randomIntegers(size_t size) {
+  std::uniform_int_distribution<long long> distribution((long long)std::numeric_limits<T>::min(),
+                                                        (long long)std::numeric_limits<T>::max());
+  std::vector<T> values(size);
+  for (T &value : values) {
+    value = (T)distribution(g_random);
+  }
+  return values;
+}
+
+std::vector<jdouble> specialDoubles() {
+  std::vector<jdouble> values = {0.0, -0.0, 1.0, -1.0, 1e-40, 1e-320, 3.4028235677973366e38, 1e39, -1e39,
+                                 HUGE_VAL, -HUGE_VAL, NAN, 0.1, 65504.0, 65520.0, 5.960464477539063e-8};
+  std::uniform_real_distribution<double> distribution(-1e6, 1e6);
+  while (values.size() < kBenchmarkSize) {
+    values.push_back(distribution(g_random));
+  }
+  return values;
+}
+
+std::vector<jfloat> specialFloats() {
+  std::vector<jfloat> values;
+  for (jdouble value : specialDoubles()) {
+    values.push_back((jfloat)value);
+  }
+  // NaN payloads, subnormal halves and the rounding boundaries around them
+  const uint32_t bits[] = {0x7fc00001u, 0xffa00000u, 0x7f802000u, 0x33000000u, 0x33000001u, 0x387fc000u,
+                           0x38800000u, 0x477fe000u, 0x477ff000u, 0x477fefffu, 0x3f800fffu, 0x3f801000u};
+  for (size_t i = 0; i < sizeof(bits) / sizeof(bits[0]); ++i) {
+    memcpy(&values[i + 1], &bits[i], sizeof(jfloat));
+  }
+  return values;
+}
+
+std::vector<Half> allHalves() {
+  std::vector<Half> values(1 << 16);
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i].bits = (uint16_t)i;
+  }
+  return values;
+}
+
+std::vector<jboolean> randomBooleans(size_t size) {
+  // any non-zero jboolean counts as true
+  std::vector<jboolean> values = randomIntegers<jboolean>(size);
+  for (size_t i = 0; i < size; i += 3) {
+    values[i] = 0;
+  }
+  return values;
+}
+}
+
+int main() {
+  std::vector<jdouble> doubles = specialDoubles();
+  std::vector<jfloat> floats = specialFloats();
+  std::vector<Half> halves = allHalves();
+  std::vector<int64_t> longs = randomIntegers<int64_t>(kBenchmarkSize);
+  std::vector<jint> ints = randomIntegers<jint>(kBenchmarkSize);
+  std::vector<uint8_t> bits = randomIntegers<uint8_t>(kBenchmarkSize / 8);
+  std::vector<jboolean> booleans = randomBooleans(kBenchmarkSize);
+
+  check("doubleToFloat", convert::doubleToFloat, convert::scalar::doubleToFloat, doubles);
+  check("floatToDouble", convert::floatToDouble, convert::scalar::floatToDouble, floats);
+  check("int64ToInt32", convert::int64ToInt32, convert::scalar::int64ToInt32, longs);
+  check("int32ToInt64", convert::int32ToInt64, convert::scalar::int32ToInt64, ints);
+  check("packBits", convert::packBits, convert::scalar::packBits, booleans);
+  check("floatToHalf", convert::floatToHalf, convert::scalar::floatToHalf, floats);
+
+  // every half value, at every position of a vector
+  for (size_t start = 0; start + kMaxSize <= halves.size(); start += kMaxSize - 8) {
+    std::vector<Half> window(halves.begin() + start, halves.begin() + start + kMaxSize);
+    check("halfToFloat", convert::halfToFloat, convert::scalar::halfToFloat, window);
+  }
+
+  // unpackBits reads size bits, not size bytes
+  for (size_t size = 0; size <= kMaxSize; ++size) {
+    std::vector<jboolean> expected(size + 1, 7), actual(size + 1, 7);
+    convert::scalar::unpackBits(&bits[1], &expected[0], size);
+    convert::unpackBits(&bits[1], &actual[0], size);
+    if (expected != actual) {
+      printf("FAIL unpackBits size %zu\n", size);
+      ++g_failures;
+    }
+  }
+
+  std::vector<jfloat> benchmarkFloats(kBenchmarkSize);
+  std::vector<Half> benchmarkHalves(kBenchmarkSize);
+  convert::scalar::doubleToFloat(&doubles[0], &benchmarkFloats[0], kBenchmarkSize);
+  convert::scalar::floatToHalf(&benchmarkFloats[0], &benchmarkHalves[0], kBenchmarkSize);
+  benchmark("doubleToFloat", convert::doubleToFloat, convert::scalar::doubleToFloat, doubles);
+  benchmark("floatToDouble", convert::floatToDouble, convert::scalar::floatToDouble, benchmarkFloats);
+  benchmark("halfToFloat", convert::halfToFloat, convert::scalar::halfToFloat, benchmarkHalves);
+  benchmark("floatToHalf", convert::floatToHalf, convert::scalar::floatToHalf, benchmarkFloats);
+  benchmark("int64ToInt32", convert::int64ToInt32, convert::scalar::int64ToInt32, longs);
+  benchmark("int32ToInt64", convert::int32ToInt64, convert::scalar::int32ToInt64, ints);
+  benchmark("packBits", convert::packBits, convert::scalar::packBits, booleans);
+
+  printf(g_failures == 0 ? "convert: all kernels match scalar\n" : "convert: %d failures\n", g_failures);
+  return g_failures == 0 ? 0 : 1;
+}
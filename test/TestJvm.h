@@ -0,0 +1,63 @@
+/**
+ *  Starts an in-process JVM for the tests that need one. Link them against libjvm:
+ *
+ *  -L$JAVA_HOME/lib/server -ljvm -Wl,-rpath,$JAVA_HOME/lib/server -lpthread
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "JniCpp11.h"
+
+namespace jnicpp11 {
+namespace test {
+
+inline int &failures() {
+  static int count = 0;
+  return count;
+}
+
+#define TEST_CHECK(CONDITION)                                              \
+  do {                                                                     \
+    if (!(CONDITION)) {                                                    \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #CONDITION);          \
+      ++jnicpp11::test::failures();                                        \
+    }                                                                      \
+  } while (0)
+
+// -Xcheck:jni makes the JVM abort on JNI calls made with an exception pending or with invalid references.
+inline JNIEnv *startJvm(std::vector<std::string> options = {}) {
+  options.insert(options.begin(), "-Xcheck:jni");
+  std::vector<JavaVMOption> vmOptions(options.size());
+  for (size_t i = 0; i < options.size(); ++i) {
+    vmOptions[i].optionString = const_cast<char *>(options[i].c_str());
+    vmOptions[i].extraInfo = nullptr;
+  }
+  JavaVMInitArgs args;
+  args.version = JNI_VERSION_1_6;
+  args.nOptions = (jint)vmOptions.size();
+  args.options = vmOptions.data();
+  args.ignoreUnrecognized = JNI_FALSE;
+  JavaVM *vm = nullptr;
+  JNIEnv *env = nullptr;
+  if (JNI_CreateJavaVM(&vm, (void **)&env, &args) != JNI_OK) {
+    printf("JNI_CreateJavaVM failed\n");
+    return nullptr;
+  }
+  Jni::setJvm(vm);
+  return env;
+}
+
+inline int finish(const char *name) {
+  if (failures() == 0) {
+    printf("%s: all checks passed\n", name);
+  } else {
+    printf("%s: %d failures\n", name, failures());
+  }
+  return failures() == 0 ? 0 : 1;
+}
+}  // namespace test
+}  // namespace jnicpp11
@@ -0,0 +1,506 @@
+#!/usr/bin/env python3
+"""Generates typed JniCpp11 wrappers from compiled .class files.
+
+Usage:
+  jnicpp11_bindgen.py [-o Bindings.h] [--namespace bindings] [--class com/example/Foo ...] INPUT...
+
+INPUT can be a .class file, a .jar/.zip file or a directory containing .class files. Every public class found is
+bound unless --class is given, in which case only the listed classes (internal names, `*` suffix matches a
+package prefix) are bound.
+
+The generated header has one C++ class per Java class with one member per public Java method, constructor and
+field. Signatures are taken from the class file and baked into the header, and the member IDs live in a single
+registration table. Object parameters and return values whose class is bound in the same run use its generated class;
+other objects, arrays and fields are jnicpp11::JavaObject. Call `<namespace>::resolveBindings()` once at startup (e.g.
+from JNI_OnLoad) to resolve them all.
+"""
+
+import argparse
+import os
+import struct
+import sys
+import zipfile
+
+ACC_PUBLIC = 0x0001
+ACC_STATIC = 0x0008
+ACC_BRIDGE = 0x0040
+ACC_SYNTHETIC = 0x1000
+
+CPP_KEYWORDS = {
+    'alignas', 'alignof', 'and', 'and_eq', 'asm', 'auto', 'bitand', 'bitor', 'bool', 'break', 'case', 'catch', 'char',
+    'char16_t', 'char32_t', 'class', 'compl', 'const', 'constexpr', 'const_cast', 'continue', 'decltype', 'default',
+    'delete', 'do', 'double', 'dynamic_cast', 'else', 'enum', 'explicit', 'export', 'extern', 'false', 'float', 'for',
+    'friend', 'goto', 'if', 'inline', 'int', 'long', 'mutable', 'namespace', 'new', 'noexcept', 'not', 'not_eq',
+    'nullptr', 'operator', 'or', 'or_eq', 'private', 'protected', 'public', 'register', 'reinterpret_cast', 'return',
+    'short', 'signed', 'sizeof', 'static', 'static_assert', 'static_cast', 'struct', 'switch', 'template', 'this',
+    'thread_local', 'throw', 'true', 'try', 'typedef', 'typeid', 'typename', 'union', 'unsigned', 'using', 'virtual',
+    'void', 'volatile', 'wchar_t', 'while', 'xor', 'xor_eq',
+    # names that would clash with the members every generated class already has, or hide (or, for the virtual ones,
+    # override) a member of JavaObject or JavaClass that the library itself calls
+    'create', 'javaClass', 'ids', 'null', 'borrow', 'getJClass', 'getJObject', 'asType', 'toGlobalRef', 'getClassPath',
+    'getTypeSignature', 'field', 'call', 'callVoid', 'checkAndGetEnv', '_field', '_call', '__call', '_jobject',
+    '_javaClass', 'getClass', 'newObject', 'staticCall', 'staticCallVoid', 'staticField',
+}
+
+PRIMITIVES = {
+    'Z': ('jboolean', 'JNI_FALSE'),
+    'B': ('jbyte', '0'),
+    'C': ('jchar', '0'),
+    'S': ('jshort', '0'),
+    'I': ('jint', '0'),
+    'J': ('jlong', '0'),
+    'F': ('jfloat', '0'),
+    'D': ('jdouble', '0'),
+}
+
+
+class ClassFormatError(Exception):
+    pass
+
+
+#
+# class file parsing
+#
+
+class Reader(object):
+    def __init__(self, data):
+        self.data = data
+        self.offset = 0
+
+    def read(self, fmt):
+        values = struct.unpack_from('>' + fmt, self.data, self.offset)
+        self.offset += struct.calcsize('>' + fmt)
+        return values if len(values) > 1 else values[0]
+
+    def skip(self, size):
+        self.offset += size
+
+
+class Member(object):
+    def __init__(self, access, name, descriptor):
+        self.access = access
+        self.name = name
+        self.descriptor = descriptor
+
+    @property
+    def is_static(self):
+        return bool(self.access & ACC_STATIC)
+
+
+class JavaClassFile(object):
+    def __init__(self, name, access, fields, methods):
+        self.name = name
+        self.access = access
+        self.fields = fields
+        self.methods = methods
+
+
+def decode_modified_utf8(raw):
+    # Modified UTF-8 only differs from UTF-8 for NUL and supplementary characters, which never occur in identifiers.
+    return raw.decode('utf-8', errors='replace')
+
+
+def parse_class(data):
+    reader = Reader(data)
+    if reader.read('I') != 0xCAFEBABE:
+        raise ClassFormatError('bad magic')
+    reader.read('HH')  # minor, major version
+
+    count = reader.read('H')
+    utf8 = {}
+    classes = {}
+    index = 1
+    while index < count:
+        tag = reader.read('B')
+        if tag == 1:
+            length = reader.read('H')
+            utf8[index] = decode_modified_utf8(data[reader.offset:reader.offset + length])
+            reader.skip(length)
+        elif tag == 7:
+            classes[index] = reader.read('H')
+        elif tag in (3, 4):
+            reader.skip(4)
+        elif tag in (5, 6):
+            reader.skip(8)
+            index += 1  # longs and doubles take two slots
+        elif tag in (8, 16, 19, 20):
+            reader.skip(2)
+        elif tag in (9, 10, 11, 12, 17, 18):
+            reader.skip(4)
+        elif tag == 15:
+            reader.skip(3)
+        else:
+            raise ClassFormatError('unknown constant pool tag %d' % tag)
+        index += 1
+
+    access, this_class, _ = reader.read('HHH')
+    name = utf8[classes[this_class]]
+    reader.skip(2 * reader.read('H'))  # interfaces
+
+    def read_members():
+        members = []
+        for _ in range(reader.read('H')):
+            member_access, name_index, descriptor_index = reader.read('HHH')
+            for _ in range(reader.read('H')):
+                reader.skip(2)
+                reader.skip(reader.read('I'))
+            members.append(Member(member_access, utf8[name_index], utf8[descriptor_index]))
+        return members
+
+    fields = read_members()
+    methods = read_members()
+    return JavaClassFile(name, access, fields, methods)
+
+
+def load_classes(inputs):
+    for path in inputs:
+        if os.path.isdir(path):
+            for root, _, files in os.walk(path):
+                for file_name in sorted(files):
+                    if file_name.endswith('.class'):
+                        with open(os.path.join(root, file_name), 'rb') as f:
+                            yield parse_class(f.read())
+        elif path.endswith('.class'):
+            with open(path, 'rb') as f:
+                yield parse_class(f.read())
+        elif zipfile.is_zipfile(path):
+            with zipfile.ZipFile(path) as archive:
+                for entry in sorted(archive.namelist()):
+                    if entry.endswith('.class') and not entry.startswith('META-INF/'):
+                        yield parse_class(archive.read(entry))
+        else:
+            raise ClassFormatError('%s is not a class file, jar or directory' % path)
+
+
+#
+# descriptors
+#
+
+def parse_field_type(descriptor, offset):
+    start = offset
+    while descriptor[offset] == '[':
+        offset += 1
+    if descriptor[offset] == 'L':
+        offset = descriptor.index(';', offset) + 1
+    else:
+        offset += 1
+    return descriptor[start:offset], offset
+
+
+def parse_method_descriptor(descriptor):
+    params = []
+    offset = 1
+    while descriptor[offset] != ')':
+        param, offset = parse_field_type(descriptor, offset)
+        params.append(param)
+    return params, descriptor[offset + 1:]
+
+
+class Wrappers(object):
+    """The generated wrapper type of every class bound in this run, by descriptor."""
+
+    def __init__(self, namespace, java_classes):
+        self.prefix = '::%s::' % namespace
+        self.types = dict(('L%s;' % c.name, self.prefix + qualified_name(c.name)) for c in java_classes)
+
+    def get(self, descriptor):
+        return self.types.get(descriptor)
+
+    def relative(self, cpp_type):
+        """cpp_type as seen from the generated namespace, for the return type of an out-of-class definition."""
+        return cpp_type[len(self.prefix):] if cpp_type.startswith(self.prefix) else cpp_type
+
+
+def value_type(descriptor, wrappers):
+    """C++ type used for values of this descriptor and the default returned on failure."""
+    if descriptor in PRIMITIVES:
+        return PRIMITIVES[descriptor]
+    if descriptor == 'Ljava/lang/String;':
+        return 'std::string', '""'
+    wrapper = wrappers.get(descriptor) if wrappers else None
+    if wrapper:
+        return wrapper, '%s(jnicpp11::JavaObject(nullptr))' % wrapper
+    # classes outside this run, arrays and java/lang/Object
+    return 'jnicpp11::JavaObject', 'jnicpp11::JavaObject(nullptr)'
+
+
+def param_type(descriptor, wrappers):
+    cpp_type, _ = value_type(descriptor, wrappers)
+    return cpp_type if descriptor in PRIMITIVES else 'const %s &' % cpp_type
+
+
+#
+# code generation
+#
+
+def identifier(name):
+    name = name.replace('$', '_')
+    return name + '_' if name in CPP_KEYWORDS else name
+
+
+def class_parts(internal_name):
+    parts = internal_name.split('/')
+    return [identifier(p) for p in parts[:-1]], identifier(parts[-1])
+
+
+def qualified_name(internal_name):
+    namespaces, name = class_parts(internal_name)
+    return '::'.join(namespaces + [name])
+
+
+def matches(internal_name, patterns):
+    if not patterns:
+        return True
+    for pattern in patterns:
+        if pattern.endswith('*') and internal_name.startswith(pattern[:-1]):
+            return True
+        if internal_name == pattern:
+            return True
+    return False
+
+
+class BoundMember(object):
+    def __init__(self, kind, member, cpp_name, slot):
+        self.kind = kind
+        self.member = member
+        self.cpp_name = cpp_name
+        self.slot = slot
+
+
+def bind_members(java_class, wrappers):
+    """Picks a unique C++ name and ID slot for every public member."""
+    bound = []
+    used_signatures = {}
+    used_names = set()
+    _, class_name = class_parts(java_class.name)
+
+    def unique(name, key):
+        cpp_name = identifier(name)
+        if cpp_name in (class_name, 'Ids'):
+            cpp_name += '_'
+        if (cpp_name, key) in used_signatures or (key is None and cpp_name in used_names):
+            suffix = 2
+            while (('%s%d' % (cpp_name, suffix), key) in used_signatures or '%s%d' % (cpp_name, suffix) in used_names):
+                suffix += 1
+            cpp_name = '%s%d' % (cpp_name, suffix)
+        used_signatures[(cpp_name, key)] = True
+        used_names.add(cpp_name)
+        return cpp_name
+
+    for method in java_class.methods:
+        if not method.access & ACC_PUBLIC or method.access & (ACC_BRIDGE | ACC_SYNTHETIC):
+            continue
+        if method.name == '<clinit>':
+            continue
+        params, _ = parse_method_descriptor(method.descriptor)
+        # overloads that map to the same C++ parameter list get a numbered name
+        key = tuple(param_type(p, wrappers) for p in params)
+        if method.name == '<init>':
+            kind = 'Constructor'
+            cpp_name = 'create'
+            suffix = 2
+            while (cpp_name, key) in used_signatures:
+                cpp_name = 'create%d' % suffix
+                suffix += 1
+            used_signatures[(cpp_name, key)] = True
+        else:
+            kind = 'StaticMethod' if method.is_static else 'Method'
+            cpp_name = unique(method.name, key)
+        bound.append(BoundMember(kind, method, cpp_name, 'm%d' % len(bound)))
+
+    for field in java_class.fields:
+        if not field.access & ACC_PUBLIC or field.access & ACC_SYNTHETIC:
+            continue
+        kind = 'StaticField' if field.is_static else 'Field'
+        bound.append(BoundMember(kind, field, unique(field.name + 'Field', None), 'f%d' % len(bound)))
+    return bound
+
+
+def emit_method(out, definitions, java_class, bound, wrappers):
+    """Members that take or return generated wrapper types are only declared in the class and defined in definitions,
+    after every wrapper class is complete."""
+    _, class_name = class_parts(java_class.name)
+    params, ret = parse_method_descriptor(bound.member.descriptor)
+    types = [param_type(p, wrappers) for p in params]
+    args = ', '.join('%s%sa%d' % (t, '' if t.endswith('&') else ' ', i) for i, t in enumerate(types))
+    # wrappers are passed on as JavaObject, the type the call templates turn into a jobject and a type signature
+    forwarded = ''.join(', static_cast<const jnicpp11::JavaObject &>(a%d)' % i if wrappers.get(p) else ', a%d' % i
+                        for i, p in enumerate(params))
+    slot = 'ids().%s' % bound.slot
+    comment = '  // %s%s' % (bound.member.name, bound.member.descriptor)
+    out.append(comment)
+    uses_wrappers = any(wrappers.get(p) for p in params)
+    static = bound.kind in ('Constructor', 'StaticMethod')
+    target = 'javaClass().' if static else ''
+    if bound.kind == 'Constructor':
+        cpp_type = wrappers.get('L%s;' % java_class.name) if uses_wrappers else class_name
+        body = 'return %s(javaClass().newObject(%s%s));' % (cpp_type, slot, forwarded)
+    elif ret == 'V':
+        cpp_type = 'void'
+        body = '%s%s(%s%s);' % (target, 'staticCallVoid' if static else 'callVoid', slot, forwarded)
+    else:
+        cpp_type, default = value_type(ret, wrappers)
+        call = 'staticCall' if static else 'call'
+        if wrappers.get(ret):
+            uses_wrappers = True
+            body = 'return %s(%s%s<jnicpp11::JavaObject>(%s, jnicpp11::JavaObject(nullptr)%s));' % (
+                cpp_type, target, call, slot, forwarded)
+        else:
+            body = 'return %s%s<%s>(%s, %s%s);' % (target, call, cpp_type, slot, default, forwarded)
+    qualifier = 'static ' if static else ''
+    const = '' if static else ' const'
+    if not uses_wrappers:
+        out.append('  %s%s %s(%s)%s { %s }' % (qualifier, cpp_type, bound.cpp_name, args, const, body))
+        return
+    out.append('  %s%s %s(%s)%s;' % (qualifier, cpp_type, bound.cpp_name, args, const))
+    definitions.append('')
+    definitions.append(comment[2:])
+    definitions.append('inline %s %s::%s(%s)%s { %s }' % (wrappers.relative(cpp_type), qualified_name(java_class.name),
+                                                         bound.cpp_name, args, const, body))
+
+
+def emit_field(out, bound):
+    # JavaField reads and writes objects as JavaObject, so fields are not typed with the generated wrappers
+    cpp_type, _ = value_type(bound.member.descriptor, None)
+    out.append('  // %s %s' % (bound.member.name, bound.member.descriptor))
+    if bound.kind == 'StaticField':
+        out.append('  static jnicpp11::JavaStaticField<%s> %s() { return {javaClass(), ids().%s}; }' %
+                   (cpp_type, bound.cpp_name, bound.slot))
+    else:
+        out.append('  static jnicpp11::JavaField<%s> %s() { return {javaClass(), ids().%s}; }' %
+                   (cpp_type, bound.cpp_name, bound.slot))
+
+
+def emit_class(out, definitions, java_class, members, wrappers):
+    namespaces, class_name = class_parts(java_class.name)
+    for namespace in namespaces:
+        out.append('namespace %s {' % namespace)
+    out.append('')
+    out.append('class %s : public jnicpp11::JavaObject {' % class_name)
+    out.append(' public:')
+    out.append('  struct Ids {')
+    for bound in members:
+        id_type = 'jfieldID' if bound.kind in ('Field', 'StaticField') else 'jmethodID'
+        out.append('    %s %s = nullptr;' % (id_type, bound.slot))
+    out.append('  };')
+    out.append('')
+    out.append('  static Ids &ids() {')
+    out.append('    static Ids ids;')
+    out.append('    return ids;')
+    out.append('  }')
+    out.append('')
+    out.append('  static const jnicpp11::JavaClass &javaClass() {')
+    out.append('    static jnicpp11::JavaClass clazz = jnicpp11::JavaClass::getClass("%s");' % java_class.name)
+    out.append('    return clazz;')
+    out.append('  }')
+    out.append('')
+    out.append('  explicit %s(const jnicpp11::JavaObject &obj) : JavaObject(obj.asType(javaClass())) {}' % class_name)
+    for bound in members:
+        out.append('')
+        if bound.kind in ('Field', 'StaticField'):
+            emit_field(out, bound)
+        else:
+            emit_method(out, definitions, java_class, bound, wrappers)
+    out.append('};')
+    out.append('')
+    for namespace in reversed(namespaces):
+        out.append('}  // namespace %s' % namespace)
+    out.append('')
+
+
+def emit_declarations(out, java_classes):
+    for java_class in java_classes:
+        namespaces, class_name = class_parts(java_class.name)
+        out.extend('namespace %s {' % namespace for namespace in namespaces)
+        out.append('class %s;' % class_name)
+        out.extend('}  // namespace %s' % namespace for namespace in reversed(namespaces))
+    out.append('')
+
+
+def emit_registration(out, bound_classes):
+    out.append('inline bool resolveBindings() {')
+    for java_class, members in bound_classes:
+        if not members:
+            continue
+        qualified = qualified_name(java_class.name)
+        out.append('  static const jnicpp11::JavaMemberBinding %s_members[] = {' % qualified.replace('::', '_'))
+        for bound in members:
+            kind = 'Method' if bound.kind == 'Constructor' else bound.kind
+            is_field = kind in ('Field', 'StaticField')
+            slot = '&%s::ids().%s' % (qualified, bound.slot)
+            out.append('      {jnicpp11::JavaMemberBinding::%s, "%s", "%s", %s, %s},' %
+                       (kind, bound.member.name, bound.member.descriptor, 'nullptr' if is_field else slot,
+                        slot if is_field else 'nullptr'))
+        out.append('  };')
+    out.append('  static const jnicpp11::JavaClassBinding classes[] = {')
+    for java_class, members in bound_classes:
+        qualified = qualified_name(java_class.name)
+        if members:
+            member_table = '%s_members' % qualified.replace('::', '_')
+            out.append('      {"%s", &%s::javaClass, %s, sizeof(%s) / sizeof(%s[0])},' %
+                       (java_class.name, qualified, member_table, member_table, member_table))
+        else:
+            out.append('      {"%s", &%s::javaClass, nullptr, 0},' % (java_class.name, qualified))
+    out.append('  };')
+    out.append('  return jnicpp11::resolveBindings(classes, sizeof(classes) / sizeof(classes[0]));')
+    out.append('}')
+
+
+def generate(java_classes, namespace, inputs):
+    wrappers = Wrappers(namespace, java_classes)
+    bound_classes = [(c, bind_members(c, wrappers)) for c in java_classes]
+    out = [
+        '// Generated by jnicpp11_bindgen.py from %s. Do not edit.' % ', '.join(os.path.basename(i) for i in inputs),
+        '#pragma once',
+        '',
+        '#include <string>',
+        '',
+        '#include "JniCpp11.h"',
+        '',
+        'namespace %s {' % namespace,
+        '',
+    ]
+    classes = []
+    definitions = []
+    for java_class, members in bound_classes:
+        emit_class(classes, definitions, java_class, members, wrappers)
+    if definitions:
+        # members using the wrappers of classes defined later are declared in the class and defined after all classes
+        emit_declarations(out, java_classes)
+    out.extend(classes)
+    if definitions:
+        out.extend(definitions[1:])
+        out.append('')
+    emit_registration(out, bound_classes)
+    out.append('')
+    out.append('}  // namespace %s' % namespace)
+    return '\n'.join(out) + '\n'
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description='Generate typed JniCpp11 bindings from .class/.jar files.')
+    parser.add_argument('inputs', nargs='+', help='.class files, .jar files or directories')
+    parser.add_argument('-o', '--output', help='output header (default: stdout)')
+    parser.add_argument('--namespace', default='bindings', help='C++ namespace of the generated code')
+    parser.add_argument('--class', dest='classes', action='append', default=[],
+                        help='internal name of a class to bind, e.g. android/os/Debug or com/example/*')
+    args = parser.parse_args(argv)
+
+    try:
+        java_classes = [c for c in load_classes(args.inputs) if c.access & ACC_PUBLIC and matches(c.name, args.classes)]
+    except (ClassFormatError, struct.error, KeyError, IOError) as e:
+        sys.stderr.write('jnicpp11_bindgen: %s\n' % e)
+        return 1
+    java_classes.sort(key=lambda c: c.name)
+
+    header = generate(java_classes, args.namespace, args.inputs)
+    if args.output:
+        with open(args.output, 'w') as f:
+            f.write(header)
+    else:
+        sys.stdout.write(header)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))